@@ -0,0 +1,51 @@
+#pragma once
+#include <Arduino.h>
+
+// 二进制命令帧（小端，固定 12 字节），在 MQTT_BINARY_TOPIC 上收发：
+//   0  uint8   opcode    BinaryOpcode
+//   1  uint8   channel   通道号；flags 含 BIN_FLAG_GROUP 时为分组号
+//   2  uint16  position  目标位置，0.01 度
+//   4  uint8   flags     BIN_FLAG_*
+//   5  uint8   reserved  置 0
+//   6  uint16  sequence  序号；非 0 时设备在 MQTT_BINARY_ACK_TOPIC 上回执，并丢弃重复投递的帧
+//   8  uint32  tag       以密码为密钥的 SipHash-2-4 对前 8 字节的认证值（截断为 32 位）
+#define BINARY_FRAME_SIZE 12
+
+enum BinaryOpcode
+{
+    BIN_OP_START = 1,
+    BIN_OP_STOP = 2,
+    BIN_OP_POSITION = 3
+};
+
+#define BIN_FLAG_RESTORE 0x01
+#define BIN_FLAG_GROUP 0x02
+
+struct BinaryFrame
+{
+    uint8_t opcode;
+    uint8_t channel;
+    uint16_t position;
+    uint8_t flags;
+    uint16_t sequence;
+};
+
+enum BinaryDecodeResult
+{
+    BIN_OK,
+    BIN_BAD_LENGTH,
+    BIN_BAD_TAG
+};
+
+// 回执帧（小端，固定 8 字节）：
+//   0  uint16  sequence   命令帧的序号
+//   2  uint8   result     CommandResult
+//   3  uint8   flags      BIN_ACK_*
+//   4  uint32  latencyUs  收到命令到舵机执行的时间（微秒），重复投递时为 0
+#define BINARY_ACK_SIZE 8
+
+#define BIN_ACK_DUPLICATE 0x01 // 重复投递，未再次执行，result 为首次处理的结果
+
+BinaryDecodeResult decodeBinaryFrame(const uint8_t *data, size_t length, const char *password, BinaryFrame &frame);
+void encodeBinaryFrame(const BinaryFrame &frame, const char *password, uint8_t *out);
+void encodeBinaryAck(uint16_t sequence, uint8_t result, uint8_t flags, uint32_t latencyUs, uint8_t *out);
@@ -0,0 +1,35 @@
+#pragma once
+#include <Arduino.h>
+
+// 启动阶段，按正常启动时到达的先后排列
+enum BootStage
+{
+    BOOT_CONFIG,          // 配置存储加载完成
+    BOOT_SERVO,           // 舵机输出与舵机任务就绪，可以执行命令
+    BOOT_LED,
+    BOOT_WIFI_STARTED,    // 已发起非阻塞 WiFi 连接
+    BOOT_NETWORK_INIT,    // MQTT/HTTP/WebSocket 服务初始化完成（尚未联网）
+    BOOT_SETUP_DONE,      // setup() 返回，调度器开始运行
+    BOOT_WIFI_CONNECTED,
+    BOOT_MQTT_CONNECTED,
+    BOOT_FIRST_COMMAND,   // 第一条被接受的命令（任意传输方式）
+    BOOT_STAGE_COUNT
+};
+
+// 启动过程打点：记录每个阶段第一次到达时距上电的微秒数，到达时打印一行。
+// 之后的重复打点被忽略，因此断线重连不会覆盖启动数据
+class BootProfiler
+{
+public:
+    void mark(BootStage stage);
+    bool reached(BootStage stage) const { return _reached & (1UL << stage); }
+    unsigned long getTimeUs(BootStage stage) const { return _timeUs[stage]; }
+    const char *getResetReason() const;
+    static const char *stageName(BootStage stage);
+
+private:
+    uint32_t _reached = 0;
+    unsigned long _timeUs[BOOT_STAGE_COUNT] = {};
+};
+
+extern BootProfiler bootProfiler;
@@ -0,0 +1,52 @@
+#pragma once
+#include <ArduinoJson.h>
+#include "types.h"
+#include "config.h"
+
+// 解析后的命令，与传输方式无关。MQTT（JSON/二进制）、HTTP 与 WebSocket 都先转换成它再交给 CommandRouter
+struct Command
+{
+    CommandType type;
+    int position;   // 0.01 度
+    bool restore;   // position 命令到位后回到原位置
+    int channel;    // -1 表示未指定
+    int group;      // -1 表示未指定
+    uint16_t loops; // 仅 CMD_SEQUENCE，0 表示无限循环
+    uint8_t frameCount;
+    CommandAck ack; // 由传输层填写，parse() 置为不需要回执
+    SequenceKeyframe frames[SERVO_SEQUENCE_CAPACITY];
+};
+
+// 回执中以数值发送，只能在末尾追加
+enum CommandResult
+{
+    COMMAND_OK,
+    COMMAND_MISSING,  // 没有 command 字段
+    COMMAND_UNKNOWN,  // 命令名不在分发表中
+    COMMAND_INVALID,  // 参数格式错误
+    COMMAND_REJECTED,  // 舵机任务拒绝（序列无效或队列已满）
+    COMMAND_SUPERSEDED, // 执行前被同一通道更新的 position 命令覆盖
+    COMMAND_BAD_CHANNEL // 通道或分组不存在
+};
+
+// 解析 sequence 命令的 frames 数组，每帧为 [位置, 时长ms, 缓动] 或
+// {"position", "duration", "easing"}。返回帧数，格式错误或超出 capacity 时返回 -1
+int parseSequenceFrames(JsonArrayConst frames, SequenceKeyframe *out, int capacity);
+
+// 命令路由：命令名经完美哈希在编译期生成的分发表中定位，查找与分发都是常数时间且不分配内存。
+// 新增命令只需在 command_router.cpp 的 COMMAND_TABLE 中按哈希值填入一项
+class CommandRouter
+{
+public:
+    static CommandType lookup(const char *name);
+    static const char *name(CommandType type);
+
+    // 把 JSON 文档中的命令字段填入 command，不做密码校验（由各传输层负责）
+    CommandResult parse(JsonVariantConst doc, Command &command) const;
+    // 执行命令：舵机动作提交给舵机任务，LED 状态变化也统一在这里处理
+    CommandResult dispatch(const Command &command);
+
+    static const char *resultMessage(CommandResult result);
+};
+
+extern CommandRouter commandRouter;
@@ -2,20 +2,121 @@
 
 // 引脚配置
 #define RESET_PIN 0          // 重置按钮引脚
-#define SERVO_PIN 9          // 舵机引脚
+#define SERVO_PIN 9          // 舵机引脚（通道 0）
 #define RESET_HOLD_TIME 3000 // 重置按钮按下时间
 
-// MQTT配置
+// 多通道舵机配置
+#define SERVO_MAX_CHANNELS 8            // ESP32-S3 LEDC 通道数上限
+#define SERVO_PINS {SERVO_PIN}          // 各通道引脚，按通道号排列
+#define SERVO_GROUPS {0xFFFFFFFF}       // 分组对应的通道位掩码，分组 0 为全部通道
+
+// 舵机运动配置
+#define SERVO_MAX_VELOCITY 600.0f        // 最大速度 度/秒（约 60度/0.1秒）
+#define SERVO_MAX_ACCELERATION 6000.0f   // 最大加速度 度/秒²
+#define SERVO_MAX_JERK 150000.0f         // 最大加加速度 度/秒³（仅 S 曲线）
+#define SERVO_MOTION_PROFILE PROFILE_SCURVE
+#define SERVO_RESTORE_HOLD_MS 500        // 按下复位动作在目标位置的停留时间
+#define SERVO_SEQUENCE_CAPACITY 32       // 每通道 sequence 命令最多关键帧数
+#define SERVO_MIN_PULSE_US 544           // 默认标定，与 ESP32Servo 的默认脉宽一致
+#define SERVO_MAX_PULSE_US 2400
+#define SERVO_PULSE_LIMIT_MIN_US 500     // 标定与修正后的脉宽范围，与 ESP32Servo 接受的范围一致
+#define SERVO_PULSE_LIMIT_MAX_US 2500
+#define SERVO_CALIBRATION_POINTS 9       // 非线性修正表的点数，每 22.5 度一个点
+#define SERVO_MODEL_SPEED 600            // 默认模型：空载约 60度/0.1秒
+#define SERVO_MODEL_LATENCY_MS 20        // 一个 PWM 帧
+#define SERVO_MODEL_DEADBAND 50          // 0.01 度，约 5us 脉宽
+#define SERVO_MODEL_MAX_SAMPLES 32       // 标定时一次最多提交的测量数
+
+// 双核模式：舵机在独立的高优先级任务中按固定节拍运行，命令经无锁队列从网络任务传入
+#define SERVO_DUAL_CORE 1
+#define SERVO_TASK_CORE 0                // loop()（MQTT/HTTP/WebSocket）运行在核 1
+#define SERVO_TASK_PRIORITY (configMAX_PRIORITIES - 1) // 高于 WiFi/lwIP 任务，节拍不受协议栈影响
+#define SERVO_TASK_STACK 4096
+#define SERVO_COMMAND_QUEUE_DEPTH 16     // 必须是 2 的幂
+#define SERVO_ACK_QUEUE_DEPTH 32         // 已执行命令的回执队列，必须是 2 的幂
+
+// MQTT配置。broker 与端口可在编译时覆盖（如 -DMQTT_BROKER=\"192.168.1.10\"），
+// 只作为配置存储的默认值，已保存的设置优先
+#ifndef MQTT_BROKER
 #define MQTT_BROKER "broker.emqx.io"
+#endif
+#ifndef MQTT_PORT
 #define MQTT_PORT 1883
+#endif
 #define MQTT_TOPIC "esp32/servo"
+// 每条命令及舵机动作都打印到串口，调试用；洪泛时串口输出会拖慢网络任务和舵机任务
+#ifndef COMMAND_LOG
+#define COMMAND_LOG 0
+#endif
+#define MQTT_BINARY_TOPIC MQTT_TOPIC "/bin" // 二进制命令帧，见 binary_protocol.h
+#define MQTT_TELEMETRY_TOPIC MQTT_TOPIC "/status" // 状态遥测，不与命令主题混用，避免回环解析
+// 过渡期兼容：遥测原先以 {"running","position"} 每 5 秒发布在 MQTT_TOPIC 上。置 1 时仍按旧格式在旧主题上
+// 每 TELEMETRY_HEARTBEAT_MS 发布一次，订阅方全部迁移到 MQTT_TELEMETRY_TOPIC 后置 0
+#ifndef MQTT_LEGACY_TELEMETRY
+#define MQTT_LEGACY_TELEMETRY 1
+#endif
+#define MQTT_ACK_TOPIC MQTT_TOPIC "/ack"               // 带 seq 的 JSON 命令的回执
+#define MQTT_BINARY_ACK_TOPIC MQTT_BINARY_TOPIC "/ack" // 二进制命令的回执帧
+#define MQTT_COMMAND_QOS 1                             // 命令主题按 QoS1 订阅，重复投递由序号去重
 #define MQTT_USERNAME "emqx"
 #define MQTT_PASSWORD "public"
 #define MQTT_KEEPALIVE 60
+#define MQTT_JSON_POOL_SIZE 4096 // 命令解析使用的静态内存池大小（字节）
+#define TELEMETRY_MIN_INTERVAL_MS 50    // 状态变化时两次发布之间的最小间隔
+#define TELEMETRY_HEARTBEAT_MS 5000     // 状态不变时的全量心跳间隔
+#define TELEMETRY_BUFFER_SIZE 384       // 单条遥测消息最大长度（字节）
+// HTTP 服务器配置
+#define HTTP_MAX_CONNECTIONS 4          // 同时保持的连接数
+#define HTTP_REQUEST_BUFFER_SIZE 1536   // 每个连接的请求缓冲区，请求头加请求体不能超过该大小
+#define HTTP_MAX_PIPELINED_REQUESTS 8   // 每次轮询每个连接最多处理的请求数
+#define HTTP_IDLE_TIMEOUT_MS 5000       // 空闲连接超时
+#define HTTP_MAX_ROUTES 12
+#define HTTP_EXTRA_HEADERS_SIZE 256     // sendHeader() 附加响应头的总长度
+#define HTTP_WRITE_CHUNK_SIZE 1436      // 每次轮询每个连接最多写出的响应体字节数（约一个 TCP 报文段）
+#define METRICS_BUFFER_SIZE 8192        // /metrics 响应缓冲区
+
+// 命令链路追踪，见 trace.h。编译时加 -DENABLE_TRACE=0 移除全部打点
+#ifndef ENABLE_TRACE
+#define ENABLE_TRACE 1
+#endif
+#define TRACE_BUFFER_SIZE 64            // 保留最近多少条命令的记录，必须是 2 的幂
+#define TRACE_STAMP_QUEUE_DEPTH 32      // 舵机任务交回时间戳的队列，必须是 2 的幂
+
+// WebSocket 配置
+#define WS_PORT 81
+#define WS_PUSH_INTERVAL_MS 50 // 状态推送最小间隔
+
+// WiFi 配置
+#define WIFI_MAX_NETWORKS 4               // 已知网络数，下标越小优先级越高
+#define WIFI_FAST_CONNECT_TIMEOUT_MS 1500 // 按缓存的 BSSID/信道直连的超时
+#define WIFI_FAST_CONNECT_ATTEMPTS 3      // 连续失败这么多次后退回扫描，接入点短暂掉线时不必重新扫描
+#define WIFI_SCAN_TIMEOUT_MS 5000
+// 快速重连时把上次的 IP 当作静态地址使用，跳过 DHCP。租约因此不再续期，过期后 DHCP 服务器
+// 可能把地址分给别的设备，只在路由器为本机保留了地址时打开
+#ifndef WIFI_REUSE_IP_LEASE
+#define WIFI_REUSE_IP_LEASE 0
+#endif
+
 // AP模式配置
 #define AP_SSID "ESP32_Servo"
 #define AP_PASSWORD "12345678"
 
+// 任务调度配置（微秒）
+#define SERVO_TICK_INTERVAL_US 20000   // 舵机节拍 50Hz，与舵机 PWM 帧同步
+#define MQTT_POLL_INTERVAL_US 2000     // MQTT 轮询
+#define MQTT_POLL_DEADLINE_US 50000    // 等不到空闲时间时最多推迟这么久
+#define HTTP_POLL_INTERVAL_US 5000     // HTTP 轮询
+#define HTTP_POLL_DEADLINE_US 100000
+#define WS_POLL_INTERVAL_US 2000       // WebSocket 轮询，滑块帧需要低延迟
+#define WS_POLL_DEADLINE_US 50000
+#define LED_UPDATE_INTERVAL_US 10000   // LED 刷新
+#define WIFI_POLL_INTERVAL_US 20000    // WiFi 状态检查，连上后尽快交给 MQTT
+#define BUTTON_POLL_INTERVAL_US 10000  // 按键扫描
+
+// 配置存储：日志结构的键值记录，按页轮换写入，见 config_store.h
+#define CONFIG_PARTITION_LABEL "config" // partitions.csv 中的数据分区
+#define CONFIG_PAGE_SIZE 4096           // 闪存擦除单位
+
 // LED配置
 #define LED_PIN 48
 #define LED_COUNT 1
@@ -28,11 +129,9 @@
 #define LED_BLINK_COLOR_CYAN 0x00FFFF   // 青色
 #define LED_BLINK_COLOR_WHITE 0xFFFFFF  // 白色
 
-#define STATUS_AP "AP"
-#define STATUS_WIFI_CONNECTED "WIFI_CONNECTED"
-#define STATUS_WIFI_DISCONNECTED "WIFI_DISCONNECTED"
-#define STATUS_WIFI_CONNECTING "WIFI_CONNECTING"
-#define STATUS_WIFI_ERROR "WIFI_ERROR"
-#define STATUS_SERVO_RUNNING "SERVO_RUNNING"
-#define STATUS_SERVO_STOPPED "SERVO_STOPPED"
-#define STATUS_MQTT_RECEIVE "MQTT_RECEIVE"
+#define LED_BLINK_INTERVAL_MS 200     // 闪烁的亮/灭时长
+#define LED_BREATHE_PERIOD_MS 2000    // 呼吸灯周期
+#define LED_BREATHE_STEPS 8           // 呼吸灯每半个周期的亮度级数，每级刷新一次 LED
+#define LED_PATTERN_STEP_MS 400       // 多色图案每种颜色的持续时间
+#define LED_NOTIFY_DURATION_MS 300    // 收到命令的提示时长
+#define LED_SERVO_STOPPED_MS 1000     // 舵机停止的提示时长
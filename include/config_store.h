@@ -0,0 +1,82 @@
+#pragma once
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "types.h"
+#include "config.h"
+#include "motion_planner.h"
+
+// 持久化的全部配置，内存中常驻一份
+struct ConfigData
+{
+    WiFiCredentials networks[WIFI_MAX_NETWORKS]; // 已知网络，按优先级排列，空 ssid 表示空位
+    WiFiFastConnect wifiCache;
+    MqttSettings mqtt;
+    ServoCalibration calibration[SERVO_MAX_CHANNELS];
+    MotionLimits motion;
+    ServoModel model[SERVO_MAX_CHANNELS];
+    ServoCorrection correction[SERVO_MAX_CHANNELS];
+};
+
+// 键值写入闪存，只能在末尾追加新键
+enum ConfigKey
+{
+    CONFIG_KEY_WIFI,
+    CONFIG_KEY_MQTT,
+    CONFIG_KEY_CALIBRATION,
+    CONFIG_KEY_MOTION,
+    CONFIG_KEY_WIFI_CACHE,
+    CONFIG_KEY_SERVO_MODEL,
+    CONFIG_KEY_SERVO_CORRECTION,
+    CONFIG_KEY_COUNT
+};
+
+struct ConfigStoreStats
+{
+    uint32_t sequence;      // 当前页的代数，每次换页加一
+    int activePage;         // -1 表示分区为空
+    size_t usedBytes;       // 当前页已写入的字节数
+    unsigned long appends;  // 追加写入的提交次数
+    unsigned long compactions;
+    unsigned long corruptRecords; // 启动扫描时遇到的损坏或未提交记录
+};
+
+// 日志结构的配置存储。分区按 CONFIG_PAGE_SIZE 分页，只有一页是当前页：
+// 页首是页头（魔数、代数、格式版本、CRC），其后依次追加记录，每条记录带键、结构版本和 CRC。
+// 一次 commit() 只追加修改过的键，最后一条记录带提交标志，没有提交标志的记录在加载时被丢弃。
+// 当前页写满时把完整快照写到下一页，最后才写页头，因此掉电时旧页仍然有效；
+// 各页轮流使用，擦除次数平均分布。启动时读各页页头后顺序扫描当前页一次即可恢复全部配置
+class ConfigStore
+{
+public:
+    bool begin();
+    const ConfigData &data() const { return _data; }
+    // 修改一项配置，commit() 之前只改内存；size 必须与该键的结构大小一致
+    bool set(ConfigKey key, const void *value, size_t size);
+    template <typename T>
+    bool set(ConfigKey key, const T &value) { return set(key, &value, sizeof(T)); }
+    bool commit();
+    // 恢复全部默认值并写入
+    bool reset();
+    const ConfigStoreStats &getStats();
+
+private:
+    bool loadPage(int page);
+    bool appendRecords(uint32_t keys);
+    bool compact();
+    bool writeRecord(int page, size_t offset, int key, uint8_t flags, size_t &written);
+    void importLegacy();
+    static void setDefaults(ConfigData &data);
+    static size_t recordSize(int key);
+
+    const esp_partition_t *_partition = nullptr;
+    int _pageCount = 0;
+    int _activePage = -1;
+    uint32_t _sequence = 0;
+    size_t _writeOffset = 0;
+    bool _needsCompaction = false; // 当前页末尾有损坏或未提交的记录，不能继续追加
+    uint32_t _dirtyMask = 0;
+    ConfigData _data;
+    ConfigStoreStats _stats = {};
+};
+
+extern ConfigStore configStore;
@@ -0,0 +1,120 @@
+#pragma once
+#include <Arduino.h>
+#include <WiFi.h>
+#include <functional>
+#include "config.h"
+
+enum HttpMethod
+{
+    HTTP_METHOD_ANY,
+    HTTP_METHOD_GET,
+    HTTP_METHOD_HEAD,
+    HTTP_METHOD_POST,
+    HTTP_METHOD_PUT,
+    HTTP_METHOD_DELETE,
+    HTTP_METHOD_OPTIONS
+};
+
+// 单个连接：请求在固定缓冲区内原地解析，处理完的请求从缓冲区前部移除，剩余字节即流水线中的后续请求
+struct HttpConnection
+{
+    WiFiClient client;
+    bool active;
+    unsigned long lastActivity;
+    unsigned long receivedUs; // 缓冲区中第一个请求开始到达的时间（micros()）
+    size_t length;
+    char buffer[HTTP_REQUEST_BUFFER_SIZE + 1];
+    // 尚未写完的响应体，由 handleClient() 每次轮询写出一段；send_P 的内容直接引用 flash，其余复制到 output
+    const char *pending;
+    size_t pendingLength; // 为 0 表示没有待写数据
+    size_t pendingOffset;
+    String output;
+    bool closing; // 响应写完后关闭连接
+};
+
+struct HttpServerStats
+{
+    unsigned long accepted;
+    unsigned long requests;
+    unsigned long rejected; // 连接池已满或请求过大
+    unsigned long timeouts;
+};
+
+// 非阻塞 HTTP/1.1 服务器：连接池、keep-alive 与请求流水线。
+// handleClient() 每次只处理已经到达的数据，不会等待慢速客户端；
+// 路由回调中使用的接口（arg/header/send 等）与 Arduino WebServer 保持一致
+class HttpServer
+{
+public:
+    typedef std::function<void(void)> THandlerFunction;
+
+    explicit HttpServer(uint16_t port) : _server(port, HTTP_MAX_CONNECTIONS) {}
+
+    void begin();
+    void handleClient();
+    void on(const char *uri, HttpMethod method, THandlerFunction handler);
+    void onNotFound(THandlerFunction handler) { _notFoundHandler = handler; }
+
+    // 以下接口只在路由回调中有效
+    HttpMethod method() const { return _method; }
+    String uri() const { return String(_path, _pathLength); }
+    String arg(const char *name) const; // "plain" 为请求体，其余为查询参数
+    bool hasArg(const char *name) const;
+    String header(const char *name) const;
+    unsigned long receivedUs() const { return _current->receivedUs; } // 请求的第一批字节被读入的时间
+
+    void sendHeader(const char *name, const char *value);
+    void send(int code, const char *contentType = nullptr, const String &content = String());
+    void send(int code, const char *contentType, const char *content, size_t length);
+    void send_P(int code, const char *contentType, PGM_P content, size_t length);
+
+    int getActiveConnections() const;
+    const HttpServerStats &getStats() const { return _stats; }
+
+private:
+    struct Route
+    {
+        const char *uri;
+        HttpMethod method;
+        THandlerFunction handler;
+    };
+
+    WiFiServer _server;
+    HttpConnection _connections[HTTP_MAX_CONNECTIONS];
+    Route _routes[HTTP_MAX_ROUTES];
+    int _routeCount = 0;
+    THandlerFunction _notFoundHandler;
+    HttpServerStats _stats = {};
+
+    // 当前请求，指向连接缓冲区内部
+    HttpConnection *_current = nullptr;
+    HttpMethod _method = HTTP_METHOD_ANY;
+    const char *_path = nullptr;
+    size_t _pathLength = 0;
+    const char *_query = nullptr;
+    size_t _queryLength = 0;
+    const char *_headers = nullptr;
+    size_t _headersLength = 0;
+    const char *_body = nullptr;
+    size_t _bodyLength = 0;
+    bool _keepAlive = false;
+    bool _responded = false;
+    char _extraHeaders[HTTP_EXTRA_HEADERS_SIZE];
+    size_t _extraHeadersLength = 0;
+
+    void accept();
+    void service(HttpConnection &connection);
+    void close(HttpConnection &connection);
+    // 有未写完的响应时等写完再关闭
+    void closeAfterWrite(HttpConnection &connection);
+    void receive(HttpConnection &connection);
+    void flush(HttpConnection &connection);
+    // 解析并处理缓冲区开头的一个完整请求，返回消耗的字节数；请求不完整返回 0
+    size_t processRequest(HttpConnection &connection);
+    void dispatch();
+    bool findQueryParam(const char *name, const char **value, size_t *length) const;
+    void writeHead(int code, const char *contentType, size_t contentLength);
+    void respond(int code, const char *contentType, const char *content, size_t length, bool persistent);
+    static HttpMethod parseMethod(const char *name, size_t length);
+    static const char *statusText(int code);
+};
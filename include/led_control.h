@@ -1,21 +1,68 @@
 #pragma once
 #include <Adafruit_NeoPixel.h>
+#include "config.h"
 
+// LED 状态，数值即 LED_EFFECTS 表的下标
+enum LedStatus
+{
+    STATUS_NONE,
+    STATUS_AP,
+    STATUS_WIFI_DISCONNECTED,
+    STATUS_WIFI_CONNECTING,
+    STATUS_WIFI_ERROR,
+    STATUS_WIFI_CONNECTED,
+    STATUS_SERVO_RUNNING,
+    STATUS_SERVO_STOPPED,
+    STATUS_MQTT_RECEIVE,
+    STATUS_COUNT
+};
+
+// 优先级层，高层覆盖低层，每层只保留最近一次设置的状态
+enum LedLayer
+{
+    LED_LAYER_NETWORK, // 网络状态
+    LED_LAYER_SERVO,   // 舵机连续运行
+    LED_LAYER_NOTIFY,  // 短暂提示，到期后自动移除
+    LED_LAYER_COUNT
+};
+
+enum LedPattern
+{
+    LED_SOLID,
+    LED_BLINK,   // 亮/灭各 LED_BLINK_INTERVAL_MS
+    LED_BREATHE, // 经 gamma 校正的三角波亮度，量化为 LED_BREATHE_STEPS 级
+    LED_CYCLE    // 依次显示 colors 中的颜色
+};
+
+struct LedEffect
+{
+    LedPattern pattern;
+    LedLayer layer;
+    uint16_t durationMs; // 0 表示一直保持，直到被替换或清除
+    uint8_t colorCount;
+    uint32_t colors[3];
+};
+
+// 表驱动的 LED 动画：update() 只根据当前最高层的效果和经过的时间计算颜色，
+// 颜色变化时才调用 pixels.show()
 class LEDController
 {
 public:
     void begin();
-    void blink(uint32_t color);
-    void light(uint32_t color);
-    void changeStatus(String status);
+    void changeStatus(LedStatus status);
+    void clearLayer(LedLayer layer);
     void update();
-    String getCurrentStatus();
+    LedStatus getCurrentStatus();
 
 private:
-    unsigned long lastBlinkTime = 0;
-    bool blinkState = false;
+    static uint32_t renderFrame(const LedEffect &effect, unsigned long elapsed);
+    void expireLayers(unsigned long now);
+
     Adafruit_NeoPixel pixels;
-    String _currentStatus;
+    LedStatus _layers[LED_LAYER_COUNT] = {};
+    unsigned long _since[LED_LAYER_COUNT] = {}; // 状态进入该层的时间，动画从此刻开始计时
+    uint32_t _shownColor = 0;
+    bool _frameValid = false;
 };
 
-extern LEDController ledController;
\ No newline at end of file
+extern LEDController ledController;
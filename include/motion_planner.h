@@ -0,0 +1,65 @@
+#pragma once
+#include <Arduino.h>
+
+enum MotionProfileType
+{
+    PROFILE_TRAPEZOIDAL, // 加速度受限，速度为梯形
+    PROFILE_SCURVE       // 加加速度受限，速度斜坡为 smoothstep 曲线
+};
+
+// 定时关键帧的缓动曲线（序列播放使用），数值即 JSON 中的 easing 字段
+enum MotionEasing
+{
+    EASE_LINEAR = 0,
+    EASE_IN_OUT = 1, // smoothstep
+    EASE_IN = 2,     // 二次加速
+    EASE_OUT = 3,    // 二次减速
+    EASE_STEP = 4,   // 立即跳到目标并保持
+    EASE_COUNT
+};
+
+// 运动限制，单位：度/秒、度/秒²、度/秒³
+struct MotionLimits
+{
+    float maxVelocity;
+    float maxAcceleration;
+    float maxJerk;
+    MotionProfileType profile;
+};
+
+// 一段已规划的运动。位置单位为 0.01 度，时间单位为毫秒，采样只用整数运算
+struct MotionSegment
+{
+    int32_t from;
+    int32_t distance;     // 有符号位移
+    int32_t rampDistance; // 峰值速度 × 斜坡时间，即加速段与减速段位移之和
+    uint32_t rampMs;
+    uint32_t cruiseMs;
+    uint32_t durationMs;
+    MotionProfileType profile;
+    int8_t easing; // -1 表示按运动限制规划；否则为 MotionEasing，在 durationMs 内按曲线插值
+};
+
+class MotionPlanner
+{
+public:
+    static void plan(const MotionLimits &limits, int32_t from, int32_t to, MotionSegment &segment);
+    static void planTimed(int32_t from, int32_t to, uint32_t durationMs, MotionEasing easing, MotionSegment &segment);
+    static int32_t sample(const MotionSegment &segment, uint32_t elapsedMs);
+
+private:
+    static const int EASING_TABLE_SIZE = 64;
+
+    static void initTables();
+    static uint32_t rampIntegral(MotionProfileType profile, uint32_t t, uint32_t rampMs);
+    static uint32_t lookup(const uint32_t *table, uint32_t t, uint32_t periodMs);
+
+    // 归一化的斜坡位移 ∫r(u)du，Q16 定点，u=1 时为 0.5
+    static uint32_t _trapezoidTable[EASING_TABLE_SIZE + 1];
+    static uint32_t _scurveTable[EASING_TABLE_SIZE + 1];
+    // 定时缓动曲线 e(u)，Q16 定点，u=1 时为 1.0
+    static uint32_t _easeInOutTable[EASING_TABLE_SIZE + 1];
+    static uint32_t _easeInTable[EASING_TABLE_SIZE + 1];
+    static uint32_t _easeOutTable[EASING_TABLE_SIZE + 1];
+    static bool _tablesReady;
+};
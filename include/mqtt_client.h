@@ -3,6 +3,62 @@
 #include <WiFi.h>
 #include "types.h"
 #include "config.h"
+#include "command_router.h"
+
+// 遥测字段位，用于标记相对上次发布发生变化的字段
+enum TelemetryField
+{
+    TELEMETRY_RUNNING = 1 << 0,
+    TELEMETRY_MOVING = 1 << 1,
+    TELEMETRY_SEQUENCE = 1 << 2,
+    TELEMETRY_POSITION = 1 << 3,
+    TELEMETRY_TARGET = 1 << 4,
+    TELEMETRY_ESTIMATE = 1 << 5, // 模型估计的舵盘位置
+    TELEMETRY_ARRIVAL = 1 << 6,  // 估计的剩余到位时间
+    TELEMETRY_ALL = (1 << 7) - 1
+};
+
+// 发布时的设备状态快照，位置为整数度
+struct TelemetrySnapshot
+{
+    bool running;
+    bool moving;
+    bool sequence;
+    int16_t position[SERVO_MAX_CHANNELS];
+    int16_t target[SERVO_MAX_CHANNELS];
+    int16_t estimate[SERVO_MAX_CHANNELS];
+    int16_t arrival[SERVO_MAX_CHANNELS]; // 毫秒，超过 int16 范围时取上限
+};
+
+// 回执经哪个主题发出，对应 CommandAck::route
+enum AckRoute
+{
+    ACK_ROUTE_NONE,
+    ACK_ROUTE_JSON,  // MQTT_ACK_TOPIC，JSON
+    ACK_ROUTE_BINARY // MQTT_BINARY_ACK_TOPIC，回执帧
+};
+
+// 滑动窗口去重：记录最高序号及其之前 WINDOW 个序号是否处理过以及处理结果。
+// 序号为 bits 位无符号数，按回绕比较；比窗口更旧的序号视为控制端重启，窗口从该序号重新开始
+class SequenceWindow
+{
+public:
+    static const int WINDOW = 64;
+
+    explicit SequenceWindow(uint8_t bits) : _bits(bits) {}
+    // 序号处理过时返回 true，result 为首次处理的结果
+    bool isDuplicate(uint32_t sequence, uint8_t &result) const;
+    void record(uint32_t sequence, uint8_t result);
+
+private:
+    int32_t distance(uint32_t sequence) const; // sequence 相对 _highest 的有符号距离
+
+    uint8_t _bits;
+    bool _valid = false;
+    uint32_t _highest = 0;
+    uint64_t _seen = 0; // 第 i 位对应序号 _highest - i
+    uint8_t _results[WINDOW];
+};
 
 class MQTTClientManager
 {
@@ -10,19 +66,38 @@ public:
     void begin();
     void update();
     bool isConnected() { return mqttClient.connected(); }
+    unsigned long getDuplicateCount() const { return duplicates; }
 
 private:
+#ifdef PIO_UNIT_TESTING
+    friend struct MqttClientTestAccess;
+#endif
+
     bool setupMQTT();
     void checkConnection();
     void publishStatus();
+    static void captureTelemetry(TelemetrySnapshot &snapshot);
+    static uint8_t diffTelemetry(const TelemetrySnapshot &a, const TelemetrySnapshot &b);
+    bool writeTelemetry(const TelemetrySnapshot &snapshot, uint8_t fields);
+    void publishLegacyStatus(const TelemetrySnapshot &snapshot);
+    void publishAck(const CommandAck &ack, uint8_t result, bool duplicate);
+    void publishAcks();
     static void callback(char *topic, byte *payload, unsigned int length);
+    static void handleJsonCommand(byte *payload, unsigned int length, unsigned long receivedUs);
+    static void handleBinaryCommand(byte *payload, unsigned int length, unsigned long receivedUs);
+    static bool acceptSequence(SequenceWindow &window, Command &cmd, uint8_t route, uint32_t sequence, unsigned long receivedUs);
+    static void finishCommand(SequenceWindow &window, const Command &cmd, CommandResult result);
 
     WiFiClient espClient;
     PubSubClient mqttClient;
     unsigned long lastReconnectAttempt = 0;
+    bool retryPending = false; // 本次 WiFi 连接期间已经尝试过，之后的重试需要间隔
     unsigned long lastPublishTime = 0;
+    TelemetrySnapshot lastTelemetry;
+    bool telemetryValid = false; // false 时下一次发布全量状态
+    unsigned long lastLegacyPublishTime = 0;
+    unsigned long duplicates = 0; // 被去重丢弃的重复投递
     static const unsigned long RECONNECT_INTERVAL = 5000;
-    static const unsigned long PUBLISH_INTERVAL = 5000;
 };
 
 extern MQTTClientManager mqttManager;
\ No newline at end of file
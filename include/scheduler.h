@@ -0,0 +1,67 @@
+#pragma once
+#include <Arduino.h>
+
+typedef void (*TaskCallback)();
+
+enum TaskType
+{
+    TASK_PERIODIC, // 固定周期释放，按最早截止时间优先执行（舵机节拍）
+    TASK_SLACK     // 只在下一个周期任务释放前的空闲时间里运行（网络轮询等）
+};
+
+// 直方图按 2 的幂分桶（单位微秒）：桶 0 为 0，桶 i 为 [2^(i-1), 2^i)，最后一个桶收容更大的值
+#define SCHEDULER_HISTOGRAM_BUCKETS 20
+
+struct TaskStats
+{
+    unsigned long runs;
+    unsigned long overruns;      // 周期任务错过整周期的次数
+    unsigned long maxRuntimeUs;
+    unsigned long maxLatenessUs; // 实际开始时间相对释放时间的延迟
+    unsigned long avgRuntimeUs;  // 指数滑动平均，用于判断空闲时间是否够用
+    uint32_t runtimeHistogram[SCHEDULER_HISTOGRAM_BUCKETS];
+    uint32_t latenessHistogram[SCHEDULER_HISTOGRAM_BUCKETS];
+};
+
+class TaskScheduler
+{
+public:
+    static const int MAX_TASKS = 8;
+
+    // deadlineUs：周期任务为相对截止时间（默认等于周期）；
+    // 空闲任务超过该时间仍未等到足够空闲时则强制运行，避免饿死（默认等于周期）
+    int addTask(const char *name, TaskCallback callback, unsigned long periodUs, TaskType type, uint8_t priority,
+                unsigned long deadlineUs = 0);
+    void run();
+
+    int getTaskCount() const { return _taskCount; }
+    const char *getTaskName(int id) const { return valid(id) ? _tasks[id].name : nullptr; }
+    const TaskStats *getStats(int id) const { return valid(id) ? &_tasks[id].stats : nullptr; }
+    void resetStats();
+
+    static unsigned long bucketUpperBoundUs(int bucket) { return bucket == 0 ? 1 : 1UL << bucket; }
+
+private:
+    struct Task
+    {
+        const char *name;
+        TaskCallback callback;
+        unsigned long periodUs;
+        unsigned long deadlineUs;
+        unsigned long releaseUs; // 下次释放时间
+        TaskType type;
+        uint8_t priority; // 数值越小优先级越高
+        TaskStats stats;
+    };
+
+    bool valid(int id) const { return id >= 0 && id < _taskCount; }
+    int pickPeriodic(unsigned long now) const;
+    int pickSlack(unsigned long now) const;
+    void execute(int id, unsigned long now);
+    static void record(uint32_t *histogram, unsigned long valueUs);
+
+    Task _tasks[MAX_TASKS];
+    int _taskCount = 0;
+};
+
+extern TaskScheduler scheduler;
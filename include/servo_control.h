@@ -2,28 +2,131 @@
 #define SERVO_CONTROL_H
 
 #include <ESP32Servo.h>
+#include "config.h"
+#include "types.h"
+#include "motion_planner.h"
 
+// 动作时间线上的一个关键帧：运动到 position（0.01 度），到位后保持 holdMs 再执行下一帧
+struct ServoKeyframe
+{
+    int32_t position;
+    unsigned long holdMs;
+};
+
+// 多通道舵机引擎。每个通道的状态按字段存放在连续数组中（结构数组转数组结构），
+// update() 一次遍历所有通道完成时间线推进、轨迹插值和输出
 class ServoController
 {
 private:
-    Servo _servo;
-    bool _isRunning;
-    int _currentPosition;
+    static const int TIMELINE_CAPACITY = 16;
+
+    Servo _servos[SERVO_MAX_CHANNELS];
+    int _channelCount = 0;
+    uint32_t _runningMask = 0;
+    uint32_t _movingMask = 0;
+    uint32_t _outputMask = 0; // 已经输出过至少一次的通道
+    unsigned long _lastTickTime = 0;
+
+    // 每通道状态：位置/速度单位为 0.01 度、0.01 度/秒
+    int32_t _position[SERVO_MAX_CHANNELS]; // 轨迹插值得到的当前位置
+    int32_t _target[SERVO_MAX_CHANNELS];   // 当前运动段终点
+    int32_t _velocity[SERVO_MAX_CHANNELS];
+    int32_t _minPosition[SERVO_MAX_CHANNELS];
+    int32_t _maxPosition[SERVO_MAX_CHANNELS];
+    int32_t _output[SERVO_MAX_CHANNELS];  // 最近一次写入舵机的位置
+    uint16_t _pulse[SERVO_MAX_CHANNELS];  // 最近一次写入舵机的脉宽（微秒）
+    // 0~180 度等距各点的脉宽（微秒），由标定与非线性修正合成
+    uint16_t _pulseTable[SERVO_MAX_CHANNELS][SERVO_CALIBRATION_POINTS];
+    unsigned long _segmentStart[SERVO_MAX_CHANNELS];
+    unsigned long _lastSwitchTime[SERVO_MAX_CHANNELS];
+    MotionSegment _segments[SERVO_MAX_CHANNELS];
+
+    // 每通道运动学模型估计的舵盘位置，单位同上；_respondingMask 为正在响应指令（已过响应延迟或等待中）的通道
+    ServoModel _model[SERVO_MAX_CHANNELS];
+    int32_t _estimate[SERVO_MAX_CHANNELS];
+    int32_t _estimateVelocity[SERVO_MAX_CHANNELS];
+    unsigned long _responseStart[SERVO_MAX_CHANNELS];
+    uint32_t _respondingMask = 0;
+
+    // 每通道关键帧环形队列
+    ServoKeyframe _timeline[SERVO_MAX_CHANNELS][TIMELINE_CAPACITY];
+    uint8_t _timelineHead[SERVO_MAX_CHANNELS];
+    uint8_t _timelineCount[SERVO_MAX_CHANNELS];
+    unsigned long _keyframeEnd[SERVO_MAX_CHANNELS];
+    uint32_t _keyframeMask = 0; // 正在执行关键帧的通道
+
+    // 每通道预分配的序列缓冲区，循环播放
+    SequenceKeyframe _sequence[SERVO_MAX_CHANNELS][SERVO_SEQUENCE_CAPACITY];
+    uint8_t _sequenceLength[SERVO_MAX_CHANNELS];
+    uint8_t _sequenceIndex[SERVO_MAX_CHANNELS];
+    uint16_t _sequenceLoops[SERVO_MAX_CHANNELS]; // 0 表示一直循环
+    uint16_t _sequenceLoop[SERVO_MAX_CHANNELS];  // 已完成的循环次数
+    uint32_t _sequenceMask = 0;                  // 正在播放序列的通道
+
+    MotionLimits _limits;
+
+    bool validChannel(int channel) const { return channel >= 0 && channel < _channelCount; }
+    int32_t finalTarget(int channel) const;
+    uint16_t pulseFor(int channel, int32_t position) const;
+    void startSegment(int channel, int32_t target, unsigned long now);
+    void updateTimeline(int channel, unsigned long now);
+    void startSequenceFrame(int channel, int32_t from, unsigned long start);
+    void updateSequence(int channel, unsigned long now);
+    void sampleSegment(int channel, unsigned long now, unsigned long dt);
+    void writeOutput(int channel);
+    void updateEstimate(int channel, unsigned long now, unsigned long dt);
 
 public:
-    void begin(int pin);
-    void setRunning(bool running);
-    void setPosition(int position);
+    void begin(const int *pins, int count, const ServoCalibration *calibration = nullptr, const ServoModel *models = nullptr,
+               const ServoCorrection *corrections = nullptr);
+    int getChannelCount() const { return _channelCount; }
+    uint32_t allChannels() const { return _channelCount >= 32 ? 0xFFFFFFFF : (1UL << _channelCount) - 1; }
+
+    void setRunning(uint32_t channels, bool running);
+    bool isRunning(int channel = 0) const { return _runningMask & (1UL << channel); }
+    uint32_t getRunningMask() const { return _runningMask; }
+    // 位置参数的单位均为 0.01 度（0~18000）
+    void setPosition(int channel, int32_t position);
+    void moveTo(uint32_t channels, int32_t position);
+    bool moveAndRestore(uint32_t channels, int32_t position);
+    bool queueKeyframe(int channel, int32_t position, unsigned long holdMs);
+    void clearTimeline(int channel);
+    bool playSequence(uint32_t channels, const SequenceKeyframe *frames, int count, int loops);
+    static bool isPlayableSequence(const SequenceKeyframe *frames, int count, int loops);
+    void stopSequence(uint32_t channels) { _sequenceMask &= ~channels; }
+    bool isSequencePlaying(int channel = 0) const { return _sequenceMask & (1UL << channel); }
     void update();
-    int getCurrentPosition() const { return _currentPosition; }
 
-    static int calculateMoveTime(int fromPos, int toPos)
-    {
-        int angleDiff = abs(toPos - fromPos);
-        return (angleDiff * 100 / 60) + 500; // 假设60度/0.1秒
-    }
+    // 以下位置均为四舍五入后的整数度
+    int getCurrentPosition(int channel = 0) const { return validChannel(channel) ? (_output[channel] + 50) / 100 : 0; }
+    int getTargetPosition(int channel = 0) const { return validChannel(channel) ? (finalTarget(channel) + 50) / 100 : 0; }
+    uint16_t getPulseUs(int channel = 0) const { return validChannel(channel) ? _pulse[channel] : 0; }
+    int getVelocity(int channel = 0) const { return validChannel(channel) ? _velocity[channel] / 100 : 0; }
+    bool isMoving(int channel = 0) const { return _movingMask & (1UL << channel); }
+    // 模型估计的舵盘实际位置（度）与速度（度/秒）
+    int getEstimatedPosition(int channel = 0) const { return validChannel(channel) ? (_estimate[channel] + 50) / 100 : 0; }
+    int getEstimatedVelocity(int channel = 0) const { return validChannel(channel) ? _estimateVelocity[channel] / 100 : 0; }
+    // 估计舵盘到达当前运动段终点还需要的时间（毫秒）
+    unsigned long getArrivalMs(int channel = 0) const;
+    bool isTimelineBusy(int channel = 0) const;
+
+    void setChannelLimits(int channel, int minPosition, int maxPosition);
+    // 重新合成脉宽表，correction 为 nullptr 时为线性映射；下一次输出起生效。
+    // 只能在舵机任务中调用，其他任务经 SERVO_OP_CALIBRATE 提交
+    void setCalibration(int channel, const ServoCalibration &calibration, const ServoCorrection *correction = nullptr);
+    void setMotionLimits(const MotionLimits &limits) { _limits = limits; }
+    const MotionLimits &getMotionLimits() const { return _limits; }
+    // 只能在舵机任务中调用，其他任务经 SERVO_OP_CALIBRATE 提交
+    void setModel(int channel, const ServoModel &model);
+    const ServoModel &getModel(int channel = 0) const { return _model[validChannel(channel) ? channel : 0]; }
+
+    // 舵盘从 fromPos 实际到达 toPos 的时间（毫秒）：取运动规划时间与该通道模型的响应延迟加追赶时间中较长者
+    unsigned long calculateMoveTime(int fromPos, int toPos, int channel = 0) const;
+
+    // 命令寻址：channel >= 0 时选单个通道，否则 group >= 0 时选 SERVO_GROUPS 中的分组，都未指定时为通道 0
+    uint32_t resolveChannels(int channel, int group) const;
 };
 
 extern ServoController servoController;
 
-#endif // SERVO_CONTROL_H
\ No newline at end of file
+#endif // SERVO_CONTROL_H
@@ -0,0 +1,19 @@
+#pragma once
+#include <Arduino.h>
+#include "types.h"
+
+// 一次标定测量：舵机静止时给出 distance 的阶跃，从发出指令到舵盘停稳所用的时间。
+// 时间需在外部测量（如视频或编码器）；durationMs 为 0 表示舵机没有动作
+struct ServoModelSample
+{
+    int32_t distance; // 0.01 度
+    uint32_t durationMs;
+};
+
+class ServoModelFitter
+{
+public:
+    // 对有动作的测量按最小二乘拟合 durationMs = latencyMs + distance / speed，
+    // 至少需要两个不同的阶跃；deadband 取没有动作的最大阶跃，没有这类测量时保留 model 中的原值
+    static bool fit(const ServoModelSample *samples, int count, ServoModel &model);
+};
@@ -0,0 +1,147 @@
+#pragma once
+#include "servo_control.h"
+#include "spsc_queue.h"
+#include "triple_buffer.h"
+#include "trace.h"
+
+enum ServoOp
+{
+    SERVO_OP_START,
+    SERVO_OP_STOP, // 停止连续运行与序列播放
+    SERVO_OP_MOVE,
+    SERVO_OP_MOVE_RESTORE,
+    SERVO_OP_SEQUENCE,
+    SERVO_OP_CALIBRATE // 更新 channels 中各通道的标定参数，calibrate 指明哪些部分
+};
+
+// SERVO_OP_CALIBRATE 更新的部分
+enum ServoCalibrateParts
+{
+    CALIBRATE_MODEL = 1 << 0, // 响应模型
+    CALIBRATE_PULSE = 1 << 1  // 脉宽范围与修正表
+};
+
+// 舵机命令，按值拷贝进队列，不引用发送方的缓冲区
+struct ServoCommand
+{
+    ServoOp op;
+    uint32_t channels;
+    int16_t position; // 0.01 度
+    uint16_t loops;
+    uint8_t frameCount;
+    uint8_t calibrate; // ServoCalibrateParts 的组合
+    uint32_t order;    // 提交顺序，由 submit() 填写
+    CommandAck ack;
+#if ENABLE_TRACE
+    uint16_t traceId; // 命令的追踪编号，0 表示不追踪
+#endif
+    ServoModel model;
+    ServoCalibration calibration;
+    ServoCorrection correction;
+    SequenceKeyframe frames[SERVO_SEQUENCE_CAPACITY];
+};
+
+// 邮箱中单个通道的最新目标
+struct ServoTarget
+{
+    uint32_t order;
+    int16_t position; // 0.01 度
+    CommandAck ack;   // 多通道命令只在最低的通道上携带回执
+#if ENABLE_TRACE
+    uint16_t traceId;
+#endif
+};
+
+// 单个通道的状态，位置为整数度
+struct ServoChannelStatus
+{
+    int16_t position;         // 最近一次输出的位置
+    int16_t target;           // 时间线或序列的最终目标
+    int16_t velocity;         // 度/秒
+    int16_t estimate;         // 模型估计的舵盘位置
+    int16_t estimateVelocity; // 度/秒
+    uint16_t pulseUs;
+    uint32_t arrivalMs;       // 估计的剩余到位时间
+};
+
+// 舵机任务每个节拍末尾发布的状态快照。网络任务（MQTT/HTTP/WebSocket）只通过它读取舵机状态，
+// 不直接读 servoController，因此不会读到另一个核写到一半的数据
+struct ServoSnapshot
+{
+    uint8_t channelCount;
+    uint32_t runningMask;
+    uint32_t movingMask;
+    uint32_t sequenceMask;
+    ServoChannelStatus channels[SERVO_MAX_CHANNELS];
+};
+
+struct ServoTaskStats
+{
+    unsigned long ticks;
+    unsigned long commands;
+    unsigned long dropped;     // 队列满时被丢弃的命令
+    unsigned long acksDropped; // 回执队列满时丢弃的回执
+    unsigned long maxJitterUs; // 相邻两次节拍间隔与标称周期的最大偏差
+    unsigned long targets;     // 写入邮箱的通道目标
+    unsigned long coalesced;   // 执行前被同一通道更新的目标覆盖（网络任务计数）
+    unsigned long coalescedInTick; // 同上，发生在舵机任务等待排序时（舵机任务计数）
+};
+
+// 舵机执行上下文。SERVO_DUAL_CORE 时 begin() 创建固定在 SERVO_TASK_CORE 上的任务；否则 tick() 由调度器调用。
+// position 命令（SERVO_OP_MOVE）不进队列，而是写入每通道一格的邮箱，后写覆盖先写，
+// 一个节拍内每个通道只执行最新的目标，洪泛时延迟不随积压增长；其余命令经无锁队列按顺序执行。
+// 每条命令带提交序号，节拍内先执行序号更小的邮箱目标，因此 stop/sequence 与 position 的先后关系不变。
+// 标定参数同样作为命令在舵机任务中生效，ServoController 只被舵机任务修改。
+// submit() 只能由网络任务（单一生产者）调用；带回执的命令执行或被覆盖后由 pollAck() 取回
+class ServoTask
+{
+public:
+    void begin();
+    bool submit(const ServoCommand &command);
+    bool pollAck(CommandAck &ack);
+    void tick();
+    bool isDualCore() const { return SERVO_DUAL_CORE; }
+    // 网络任务调用：最近一个节拍发布的快照，返回的引用在下一次调用前有效
+    const ServoSnapshot &snapshot();
+    // 网络任务调用，acksDropped 含网络任务丢弃的覆盖回执
+    ServoTaskStats getStats() const;
+
+private:
+    static void run(void *parameter);
+    void apply(const ServoCommand &command);
+    void postTargets(const ServoCommand &command);
+    void collectTargets();
+    void applyTargets(uint32_t channels, uint32_t before);
+    void complete(const CommandAck &ack, uint16_t traceId);
+    void supersede(const CommandAck &ack);
+    void publishSnapshot();
+
+    SpscQueue<ServoCommand, SERVO_COMMAND_QUEUE_DEPTH> _queue;
+    SpscQueue<CommandAck, SERVO_ACK_QUEUE_DEPTH> _acks;       // 舵机任务生产，网络任务消费
+    SpscQueue<CommandAck, SERVO_ACK_QUEUE_DEPTH> _superseded; // 网络任务内部：写邮箱时被覆盖的命令的回执
+    TripleBuffer<ServoTarget> _targets[SERVO_MAX_CHANNELS]; // 网络任务写，舵机任务读
+    TripleBuffer<ServoSnapshot> _snapshots;                 // 舵机任务写，网络任务读
+    uint32_t _submitted = 0;              // 网络任务独占
+    std::atomic<uint32_t> _published{0}; // 已完整提交的最大序号
+    ServoTarget _pending[SERVO_MAX_CHANNELS]; // 舵机任务已取出、等待按序执行的目标
+    uint32_t _pendingMask = 0;
+
+    // 统计按写入方分开：网络任务独占的是普通变量，舵机任务写、网络任务读的是原子变量
+    unsigned long _dropped = 0;
+    unsigned long _targetsPosted = 0;
+    unsigned long _coalesced = 0;
+    unsigned long _supersededDropped = 0; // _superseded 满时丢弃的回执
+    std::atomic<unsigned long> _ticks{0};
+    std::atomic<unsigned long> _commands{0};
+    std::atomic<unsigned long> _acksDropped{0};
+    std::atomic<unsigned long> _maxJitterUs{0};
+    std::atomic<unsigned long> _coalescedInTick{0};
+    unsigned long _lastTickUs = 0;
+#if ENABLE_TRACE
+    // 本节拍执行过的被追踪命令，servoController.update() 输出后打点
+    uint16_t _tracePending[SERVO_COMMAND_QUEUE_DEPTH + SERVO_MAX_CHANNELS];
+    int _tracePendingCount = 0;
+#endif
+};
+
+extern ServoTask servoTask;
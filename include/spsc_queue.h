@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <stddef.h>
+
+// 单生产者/单消费者无锁环形队列。生产者只写 _tail，消费者只写 _head，
+// 元素写入在 release 存储 _tail 之前完成，因此跨核传递不需要加锁。
+// Capacity 必须是 2 的幂，实际可用容量为 Capacity - 1
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // 只能由生产者调用；队列满时返回 false
+    bool push(const T &item)
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        size_t next = (tail + 1) & (Capacity - 1);
+        if (next == _head.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        _items[tail] = item;
+        _tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // 只能由消费者调用；队列空时返回 false
+    bool pop(T &item)
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        item = _items[head];
+        _head.store((head + 1) & (Capacity - 1), std::memory_order_release);
+        return true;
+    }
+
+    // 只能由消费者调用；队列空时返回 nullptr，返回的元素在 pop() 或 drop() 之前有效
+    const T *front() const
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+        return &_items[head];
+    }
+
+    // 只能由消费者调用，丢弃 front() 返回的元素；队列不能为空
+    void drop()
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        _head.store((head + 1) & (Capacity - 1), std::memory_order_release);
+    }
+
+    bool empty() const
+    {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+    }
+
+private:
+    T _items[Capacity];
+    std::atomic<size_t> _head{0};
+    std::atomic<size_t> _tail{0};
+};
@@ -0,0 +1,102 @@
+#pragma once
+#include <ArduinoJson.h>
+
+// ArduinoJson 分配器：在固定大小的静态缓冲区里顺序分配，不使用堆。
+// 文档 clear() 或重新反序列化时会释放全部块，此时缓冲区整体复位，
+// 因此适合“每条消息解析一次、用完即弃”的场景
+template <size_t Capacity>
+class StaticPoolAllocator : public ArduinoJson::Allocator
+{
+public:
+    void *allocate(size_t size) override
+    {
+        size_t total = HEADER_SIZE + align(size);
+        if (_used + total > Capacity)
+        {
+            _failures++;
+            return nullptr;
+        }
+        uint8_t *block = _buffer + _used;
+        *(size_t *)block = size;
+        _last = block;
+        _used += total;
+        _live++;
+        if (_used > _peak)
+        {
+            _peak = _used;
+        }
+        return block + HEADER_SIZE;
+    }
+
+    void deallocate(void *ptr) override
+    {
+        if (!ptr)
+        {
+            return;
+        }
+        uint8_t *block = (uint8_t *)ptr - HEADER_SIZE;
+        if (block == _last)
+        {
+            _used = block - _buffer;
+            _last = nullptr;
+        }
+        if (--_live == 0)
+        {
+            _used = 0;
+            _last = nullptr;
+        }
+    }
+
+    void *reallocate(void *ptr, size_t newSize) override
+    {
+        if (!ptr)
+        {
+            return allocate(newSize);
+        }
+        uint8_t *block = (uint8_t *)ptr - HEADER_SIZE;
+        size_t oldSize = *(size_t *)block;
+
+        // 最后一块可以原地伸缩；其他块缩小时也原地保留
+        if (block == _last && (size_t)(block - _buffer) + HEADER_SIZE + align(newSize) <= Capacity)
+        {
+            *(size_t *)block = newSize;
+            _used = block - _buffer + HEADER_SIZE + align(newSize);
+            if (_used > _peak)
+            {
+                _peak = _used;
+            }
+            return ptr;
+        }
+        if (newSize <= oldSize)
+        {
+            *(size_t *)block = newSize;
+            return ptr;
+        }
+
+        void *moved = allocate(newSize);
+        if (!moved)
+        {
+            return nullptr;
+        }
+        memcpy(moved, ptr, oldSize);
+        deallocate(ptr);
+        return moved;
+    }
+
+    size_t used() const { return _used; }
+    size_t peak() const { return _peak; }
+    unsigned long failures() const { return _failures; }
+
+private:
+    static const size_t ALIGNMENT = 8;
+    static const size_t HEADER_SIZE = ALIGNMENT;
+
+    static size_t align(size_t size) { return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+
+    alignas(8) uint8_t _buffer[Capacity];
+    uint8_t *_last = nullptr;
+    size_t _used = 0;
+    size_t _peak = 0;
+    int _live = 0;
+    unsigned long _failures = 0;
+};
@@ -0,0 +1,122 @@
+#pragma once
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "config.h"
+#include "spsc_queue.h"
+
+// 命令从到达到舵机输出经过的阶段。时间戳取 esp_timer_get_time() 的低 32 位（微秒）：
+// 舵机输出在另一个核上打点，CPU 周期计数各核独立，不能与接收时间相减
+enum TraceStage
+{
+    TRACE_RECEIVE,     // 传输层收到命令
+    TRACE_PARSE,       // 解析完成
+    TRACE_AUTH,        // 密码或认证标签校验通过（HTTP/WebSocket 没有这一阶段）
+    TRACE_DISPATCH,    // 交给舵机任务
+    TRACE_SERVO_WRITE, // 舵机任务执行命令后的第一次输出
+    TRACE_STAGE_COUNT
+};
+
+enum TraceSource
+{
+    TRACE_SOURCE_MQTT,
+    TRACE_SOURCE_MQTT_BINARY,
+    TRACE_SOURCE_HTTP,
+    TRACE_SOURCE_WS,
+    TRACE_SOURCE_COUNT
+};
+
+enum TraceCounter
+{
+    TRACE_PARSE_FAILURES,
+    TRACE_AUTH_FAILURES,
+    TRACE_MQTT_RECONNECTS, // MQTT 连接尝试
+    TRACE_WIFI_RECONNECTS, // WiFi 掉线后重新连接
+    TRACE_COUNTER_COUNT
+};
+
+#if ENABLE_TRACE
+
+// 延迟直方图的桶上界（微秒），最后还有一个 +Inf 桶
+#define TRACE_BUCKET_COUNT 12
+
+struct TraceRecord
+{
+    uint16_t id;     // 递增编号（跳过 0），用于识别已被覆盖的记录
+    uint8_t source;  // TraceSource
+    uint8_t stages;  // 已到达阶段的位掩码
+    uint32_t timeUs[TRACE_STAGE_COUNT];
+};
+
+// 各阶段距 TRACE_RECEIVE 的延迟分布
+struct TraceHistogram
+{
+    uint32_t buckets[TRACE_BUCKET_COUNT + 1];
+    uint32_t count;
+    uint64_t sumUs;
+};
+
+// 命令链路追踪。网络任务中的阶段直接写入环形缓冲区的当前记录；舵机输出发生在舵机任务中，
+// 时间戳经无锁队列交回，由网络任务在下一条命令到达或读取指标时合并，缓冲区只被网络任务修改。
+// 只通过 trace.h 末尾的宏使用，ENABLE_TRACE 为 0 时宏展开为空，不占用任何内存和时间
+class Tracer
+{
+public:
+    void begin(TraceSource source);
+    // receivedUs 为传输层读到数据的时间（micros()，在 ESP32 上即 esp_timer 时钟）
+    void begin(TraceSource source, uint32_t receivedUs);
+    void stage(TraceStage stage);
+    void count(TraceCounter counter) { _counters[counter]++; }
+    // 当前命令的记录编号，随舵机命令传给舵机任务；0 表示没有正在追踪的命令
+    uint16_t currentId() const { return _currentId; }
+    // 舵机任务调用：编号为 id 的命令已输出
+    void servoWritten(uint16_t id);
+    // 合并舵机任务交回的时间戳
+    void collect();
+
+    static uint32_t bucketUpperBoundUs(int bucket);
+    static const char *stageName(TraceStage stage);
+    static const char *sourceName(TraceSource source);
+
+    const TraceHistogram &getHistogram(TraceStage stage) const { return _histograms[stage]; }
+    unsigned long getCommands(TraceSource source) const { return _commands[source]; }
+    unsigned long getCounter(TraceCounter counter) const { return _counters[counter]; }
+    unsigned long getDroppedStamps() const { return _droppedStamps; }
+    // 环形缓冲区中的记录，0 为最新的一条；记录已被覆盖或不存在时返回 nullptr
+    const TraceRecord *getRecord(int age) const;
+
+private:
+    struct ServoStamp
+    {
+        uint16_t id;
+        uint32_t timeUs;
+    };
+
+    static uint16_t nextId(uint16_t id) { return id == 0xFFFF ? 1 : id + 1; }
+    TraceRecord &slot(uint16_t id) { return _records[id & (TRACE_BUFFER_SIZE - 1)]; }
+    void record(TraceRecord &record, TraceStage stage, uint32_t timeUs);
+    static uint32_t now() { return (uint32_t)esp_timer_get_time(); }
+
+    TraceRecord _records[TRACE_BUFFER_SIZE] = {};
+    uint16_t _currentId = 0;
+    TraceHistogram _histograms[TRACE_STAGE_COUNT] = {};
+    unsigned long _commands[TRACE_SOURCE_COUNT] = {};
+    unsigned long _counters[TRACE_COUNTER_COUNT] = {};
+    unsigned long _droppedStamps = 0;
+    SpscQueue<ServoStamp, TRACE_STAMP_QUEUE_DEPTH> _servoStamps; // 舵机任务生产，网络任务消费
+};
+
+extern Tracer tracer;
+
+#define TRACE_BEGIN(src) tracer.begin(src)
+#define TRACE_BEGIN_AT(src, us) tracer.begin(src, us)
+#define TRACE_STAGE(st) tracer.stage(st)
+#define TRACE_COUNT(ctr) tracer.count(ctr)
+
+#else
+
+#define TRACE_BEGIN(src) ((void)0)
+#define TRACE_BEGIN_AT(src, us) ((void)0)
+#define TRACE_STAGE(st) ((void)0)
+#define TRACE_COUNT(ctr) ((void)0)
+
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+
+// 三缓冲：单生产者写 back() 后用 publish() 与 middle 交换，单消费者用 acquire() 把 middle 换到 front() 后读取。
+// 两边始终各自独占一格，交换是唯一的同步点；读写都不等待，消费者读到的总是某一次完整发布的值
+template <typename T>
+class TripleBuffer
+{
+public:
+    // 只能由生产者调用
+    T &back() { return _entries[_back]; }
+
+    // 只能由生产者调用。返回 true 表示上一次发布的值尚未被取走即被覆盖，它现在位于 back() 中
+    bool publish()
+    {
+        uint8_t previous = _middle.exchange(_back | FRESH, std::memory_order_acq_rel);
+        _back = previous & INDEX;
+        return previous & FRESH;
+    }
+
+    // 只能由消费者调用；有新发布的值时换到 front() 并返回 true
+    bool acquire()
+    {
+        if (!(_middle.load(std::memory_order_acquire) & FRESH))
+        {
+            return false;
+        }
+        uint8_t previous = _middle.exchange(_front, std::memory_order_acq_rel);
+        _front = previous & INDEX;
+        return true;
+    }
+
+    // 只能由消费者调用，在下一次 acquire() 之前有效
+    const T &front() const { return _entries[_front]; }
+
+private:
+    static const uint8_t INDEX = 0x03;
+    static const uint8_t FRESH = 0x04; // middle 中的值尚未被消费者取走
+
+    T _entries[3] = {};
+    std::atomic<uint8_t> _middle{1};
+    uint8_t _back = 0;  // 生产者独占
+    uint8_t _front = 2; // 消费者独占
+};
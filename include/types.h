@@ -1,6 +1,7 @@
 #pragma once
 #include <Arduino.h>
 #include <ArduinoJson.h>
+#include "config.h"
 
 struct Response
 {
@@ -12,15 +13,12 @@ struct Response
 
 struct DeviceStatus
 {
-    bool isServoRunning;
-    int servoPosition;
     bool isWiFiConnected;
     bool isWiFiConnecting;
     float voltage;
     String wifiSSID;
     String wifiIP;
     String wifiPasswd;
-    int servoSpeed;
     String mqttTopic;
 };
 
@@ -30,10 +28,75 @@ struct WiFiCredentials
     char password[64];
 };
 
-struct MQTTCommand
+enum CommandType
 {
-    String command;
-    int position;
-    int restore;
-    String pwd;
-};
\ No newline at end of file
+    CMD_NONE, // 消息中没有 command 字段
+    CMD_START,
+    CMD_STOP,
+    CMD_POSITION,
+    CMD_SEQUENCE,
+    CMD_UNKNOWN
+};
+
+// sequence 命令的一帧：在 durationMs 内按 easing（MotionEasing）曲线运动到 position（0.01 度）
+struct SequenceKeyframe
+{
+    int16_t position;
+    uint16_t durationMs;
+    uint8_t easing;
+};
+
+// 命令回执：route 为 0 表示不需要回执，其余取值由提交命令的传输层定义。
+// 随命令进入舵机任务，执行时填入 appliedUs 后交回传输层
+struct CommandAck
+{
+    uint8_t route;
+    uint8_t result; // CommandResult，由舵机任务填写
+    uint32_t sequence;
+    unsigned long receivedUs; // 传输层收到命令的时间
+    unsigned long appliedUs;  // 舵机任务执行命令的时间
+};
+
+// 上次成功连接的接入点与 IP 租约，用于重连时跳过扫描和 DHCP。channel 为 0 表示没有缓存
+struct WiFiFastConnect
+{
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint8_t network; // 已知网络列表中的下标
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+};
+
+// MQTT 连接参数，默认值来自 config.h
+struct MqttSettings
+{
+    char broker[64];
+    uint16_t port;
+    char username[32];
+    char password[32];
+};
+
+// 舵机脉宽标定：0 度与 180 度对应的脉宽（微秒）
+struct ServoCalibration
+{
+    uint16_t minPulseUs;
+    uint16_t maxPulseUs;
+};
+
+// 舵机非线性修正：0~180 度之间等距的 SERVO_CALIBRATION_POINTS 个点上相对线性映射的脉宽修正（微秒），
+// 点之间线性插值。全为 0 时即线性映射
+struct ServoCorrection
+{
+    int16_t offsetUs[SERVO_CALIBRATION_POINTS];
+};
+
+// 舵机的运动学模型，用于估计舵盘的实际位置：收到新的脉宽后经过 latencyMs 才开始转动，
+// 之后以 speed 匀速追赶；静止时与指令的偏差不超过 deadband 时不会动作
+struct ServoModel
+{
+    uint16_t speed;     // 度/秒
+    uint16_t latencyMs;
+    uint16_t deadband;  // 0.01 度
+};
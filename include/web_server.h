@@ -1,6 +1,5 @@
 #pragma once
-#include <WebServer.h>
-#include <EEPROM.h>
+#include "http_server.h"
 #include "types.h"
 #include "config.h"
 
@@ -17,9 +16,21 @@ private:
     void handleSetWiFi();
     void handleNotFound();
     void handleControl();
+    void handleCalibrate();
     void handleResetWiFi();
+    void handleScheduler();
+    void handleMetrics();
+#if ENABLE_TRACE
+    void handleTrace();
+#endif
     String getContentType(String filename);
     void sendResponse(Response &response);
+    void scheduleRestart();
+
+    // 保存设置后延迟重启，让响应先发送出去；不在处理函数里阻塞等待
+    bool restartPending = false;
+    unsigned long restartRequestedAt = 0;
+    static const unsigned long RESTART_DELAY = 1000;
 };
 
 extern WebServerManager webServerManager;
\ No newline at end of file
@@ -2,15 +2,50 @@
 #define WIFI_MANAGER_H
 
 #include <WiFi.h>
-#include <EEPROM.h>
 #include "types.h"
 
+enum WiFiState
+{
+    WIFI_STATE_IDLE,       // 未配置或已放弃
+    WIFI_STATE_SCANNING,   // 异步扫描中，完成后选择优先级最高的可见网络
+    WIFI_STATE_CONNECTING, // 已调用 WiFi.begin()，等待结果
+    WIFI_STATE_CONNECTED,
+    WIFI_STATE_BACKOFF,    // 连接失败，等待退避时间到后重试
+    WIFI_STATE_AP
+};
+
+enum WiFiAttempt
+{
+    WIFI_ATTEMPT_FAST,    // 按缓存的 BSSID/信道直连，沿用上次的 IP
+    WIFI_ATTEMPT_SCANNED, // 按扫描结果连接
+    WIFI_ATTEMPT_BLIND    // 扫描不到已知网络（可能是隐藏网络），按优先级轮流直接连接
+};
+
+// 已知网络按优先级保存在配置存储中，上次成功连接的接入点与 IP 租约也一并缓存。
+// 重连时先用缓存直连，跳过扫描和 DHCP；失败后才扫描
 class WiFiManager
 {
 private:
-    unsigned long lastReconnectAttempt = 0;
+    WiFiState state = WIFI_STATE_IDLE;
+    WiFiAttempt attemptKind = WIFI_ATTEMPT_SCANNED;
+    int attemptNetwork = 0;
+    int blindNetwork = 0;
+    int fastFailures = 0;                   // 快速重连连续失败次数，达到上限后直到下一次成功连接前不再使用缓存
+    unsigned long lastReconnectAttempt = 0; // 本次连接尝试开始的时间（含扫描）
+    unsigned long attemptStart = 0;         // 本次 WiFi.begin() 的时间
+    unsigned long lastConnectDuration = 0;
+    unsigned long backoffDelay = 0;         // 下一次尝试距 lastReconnectAttempt 的等待时间
     int reconnectAttempts = 0;
     static const int MAX_RECONNECT_ATTEMPTS = 3;
+    static const unsigned long CONNECT_TIMEOUT = 30000;
+    static const unsigned long BACKOFF_BASE = 1000;
+    static const unsigned long BACKOFF_MAX = 30000;
+
+    void startAttempt();
+    void beginNetwork(int index, int32_t channel, const uint8_t *bssid, WiFiAttempt kind);
+    void selectScannedNetwork();
+    void onConnected();
+    void onAttemptFailed();
 
 public:
     void begin();
@@ -18,13 +53,17 @@ public:
     bool connect();
     void setupAP();
     bool resetSettings();
+    // 新网络放在最前面（优先级最高）；已存在的同名网络先移除
     bool saveCredentials(const char *ssid, const char *password);
     bool reconnect();
     bool loadCredentials();
     void clearCredentials();
     void resetReconnectCount();
+    int getNetworkCount() const;
+    WiFiState getState() const { return state; }
+    unsigned long getLastConnectDuration() const { return lastConnectDuration; } // 最近一次从开始尝试到连上的毫秒数
 };
 
 extern WiFiManager wifiManager;
 
-#endif
\ No newline at end of file
+#endif
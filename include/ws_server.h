@@ -0,0 +1,29 @@
+#pragma once
+#include <WebSocketsServer.h>
+#include "types.h"
+#include "config.h"
+
+// WebSocket 二进制帧：[操作码][通道][位置低字节][位置高字节]，位置单位 0.01 度
+#define WS_FRAME_SIZE 4
+#define WS_OP_POSITION 0x01
+
+// 网页实时通道：状态变化时主动推送，接收滑块拖动时的高频二进制位置帧
+class WebSocketManager
+{
+public:
+    void begin();
+    void update();
+
+private:
+    static void onEvent(uint8_t num, WStype_t type, uint8_t *payload, size_t length);
+    static void handleBinary(const uint8_t *payload, size_t length);
+    size_t buildStatus(char *buffer, size_t size);
+    void pushStatus();
+
+    unsigned long lastPushTime = 0;
+    int lastPosition = -1;
+    int lastTarget = -1;
+    bool lastRunning = false;
+};
+
+extern WebSocketManager wsManager;
@@ -0,0 +1,75 @@
+# 构建前把 web/ 下的页面压缩成 gzip 字节数组，生成 include/web_assets.h
+# PlatformIO 通过 extra_scripts = pre:scripts/build_web.py 调用，也可以直接运行：
+#   python scripts/build_web.py
+import gzip
+import hashlib
+import os
+import re
+
+try:
+    Import("env")  # noqa: F821
+    PROJECT_DIR = env["PROJECT_DIR"]  # noqa: F821
+except NameError:
+    PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+ASSETS = [
+    # (源文件, 数组名)
+    ("web/index.html", "INDEX_HTML"),
+]
+OUTPUT = os.path.join(PROJECT_DIR, "include", "web_assets.h")
+
+
+def minify(html):
+    # 保守压缩：去掉 HTML 注释、行首尾空白、空行和整行的 // 注释，保留换行以免改变 JS 语义
+    html = re.sub(r"<!--.*?-->", "", html, flags=re.S)
+    lines = []
+    for line in html.splitlines():
+        line = line.strip()
+        if not line or line.startswith("//"):
+            continue
+        lines.append(line)
+    return "\n".join(lines)
+
+
+def to_array(data):
+    rows = []
+    for i in range(0, len(data), 16):
+        rows.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return "\n".join(rows)
+
+
+def build():
+    parts = [
+        "// 由 scripts/build_web.py 生成，请修改 web/ 下的源文件",
+        "#pragma once",
+        "#include <Arduino.h>",
+        "",
+    ]
+    for source, name in ASSETS:
+        with open(os.path.join(PROJECT_DIR, source), encoding="utf-8") as f:
+            text = minify(f.read())
+        # mtime=0 保证相同输入生成相同字节，ETag 只随内容变化
+        data = gzip.compress(text.encode("utf-8"), compresslevel=9, mtime=0)
+        etag = hashlib.sha1(data).hexdigest()[:16]
+        parts += [
+            "// %s: %d 字节，gzip 后 %d 字节" % (source, len(text.encode("utf-8")), len(data)),
+            "#define %s_ETAG \"\\\"%s\\\"\"" % (name, etag),
+            "const size_t %s_GZ_LEN = %d;" % (name, len(data)),
+            "const uint8_t %s_GZ[] PROGMEM = {" % name,
+            to_array(data),
+            "};",
+            "",
+        ]
+    content = "\n".join(parts)
+
+    # 内容不变时不重写，避免触发重新编译
+    if os.path.exists(OUTPUT):
+        with open(OUTPUT, encoding="utf-8") as f:
+            if f.read() == content:
+                return
+    with open(OUTPUT, "w", encoding="utf-8") as f:
+        f.write(content)
+    print("build_web: generated %s" % os.path.relpath(OUTPUT, PROJECT_DIR))
+
+
+build()
@@ -0,0 +1,42 @@
+#pragma once
+#include <Arduino.h>
+#include <vector>
+
+typedef uint16_t neoPixelType;
+
+#define NEO_RGB ((0 << 6) | (0 << 4) | (1 << 2) | (2))
+#define NEO_GRB ((1 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_KHZ800 0x0000
+
+// NeoPixel 替身：只保存颜色并统计 show() 次数（对应真机上的一次 RMT 传输）
+class Adafruit_NeoPixel
+{
+public:
+    Adafruit_NeoPixel() {}
+    Adafruit_NeoPixel(uint16_t n, int16_t pin = 6, neoPixelType type = NEO_GRB + NEO_KHZ800)
+        : _pin(pin), _pixels(n, 0) {}
+
+    void begin() {}
+    void show();
+    void clear() { std::fill(_pixels.begin(), _pixels.end(), 0); }
+    void setBrightness(uint8_t b) { _brightness = b; }
+    uint8_t getBrightness() const { return _brightness; }
+    void setPixelColor(uint16_t n, uint32_t c)
+    {
+        if (n < _pixels.size())
+            _pixels[n] = c;
+    }
+    void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b) { setPixelColor(n, Color(r, g, b)); }
+    uint32_t getPixelColor(uint16_t n) const { return n < _pixels.size() ? _pixels[n] : 0; }
+    uint16_t numPixels() const { return _pixels.size(); }
+
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b)
+    {
+        return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+    }
+
+private:
+    int16_t _pin = -1;
+    uint8_t _brightness = 255;
+    std::vector<uint32_t> _pixels;
+};
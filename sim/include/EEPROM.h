@@ -0,0 +1,41 @@
+#pragma once
+#include <Arduino.h>
+#include <vector>
+
+// 用文件模拟的 EEPROM，路径由 SIM_EEPROM_FILE 指定（默认 sim_eeprom.bin）
+class EEPROMClass
+{
+public:
+    bool begin(size_t size);
+    void end() { _data.clear(); }
+    uint8_t read(int address) { return address >= 0 && (size_t)address < _data.size() ? _data[address] : 0; }
+    void write(int address, uint8_t value)
+    {
+        if (address >= 0 && (size_t)address < _data.size())
+            _data[address] = value;
+    }
+    bool commit();
+    size_t length() const { return _data.size(); }
+    uint8_t *getDataPtr() { return _data.data(); }
+
+    template <typename T>
+    T &get(int address, T &t)
+    {
+        if (address >= 0 && address + sizeof(T) <= _data.size())
+            memcpy((uint8_t *)&t, _data.data() + address, sizeof(T));
+        return t;
+    }
+
+    template <typename T>
+    const T &put(int address, const T &t)
+    {
+        if (address >= 0 && address + sizeof(T) <= _data.size())
+            memcpy(_data.data() + address, (const uint8_t *)&t, sizeof(T));
+        return t;
+    }
+
+private:
+    std::vector<uint8_t> _data;
+};
+
+extern EEPROMClass EEPROM;
@@ -0,0 +1,33 @@
+#pragma once
+#include <Arduino.h>
+
+#define DEFAULT_uS_LOW 544
+#define DEFAULT_uS_HIGH 2400
+
+// 记录型舵机：每次输出都写入 sim::servoLog()，便于离线检查时序
+class Servo
+{
+public:
+    int attach(int pin) { return attach(pin, DEFAULT_uS_LOW, DEFAULT_uS_HIGH); }
+    int attach(int pin, int min, int max);
+    void detach() { _pin = -1; }
+    void write(int value);
+    void writeMicroseconds(int value);
+    int read() const;
+    int readMicroseconds() const { return _us; }
+    bool attached() const { return _pin >= 0; }
+    void setPeriodHertz(int hertz) { _periodHertz = hertz; }
+
+private:
+    int _pin = -1;
+    int _min = DEFAULT_uS_LOW;
+    int _max = DEFAULT_uS_HIGH;
+    int _us = 0;
+    int _periodHertz = 50;
+};
+
+class ESP32PWM
+{
+public:
+    static void allocateTimer(int timerNumber) {}
+};
@@ -0,0 +1,19 @@
+#pragma once
+#include "Stream.h"
+
+// 串口输出到 stdout；设置 SIM_QUIET=1 可关闭，避免性能分析时被 IO 干扰
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long baud);
+    void end() {}
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
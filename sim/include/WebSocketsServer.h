@@ -0,0 +1,60 @@
+#pragma once
+#include <functional>
+#include <deque>
+#include <vector>
+#include <Arduino.h>
+
+#define WEBSOCKETS_SERVER_CLIENT_MAX 5
+
+typedef enum
+{
+    WStype_ERROR,
+    WStype_DISCONNECTED,
+    WStype_CONNECTED,
+    WStype_TEXT,
+    WStype_BIN,
+    WStype_FRAGMENT_TEXT_START,
+    WStype_FRAGMENT_BIN_START,
+    WStype_FRAGMENT,
+    WStype_FRAGMENT_FIN,
+    WStype_PING,
+    WStype_PONG,
+} WStype_t;
+
+// 模拟 WebSocketsServer：客户端与消息通过 sim::wsOpen()/wsSend() 注入，loop() 中分发
+class WebSocketsServer
+{
+public:
+    typedef std::function<void(uint8_t num, WStype_t type, uint8_t *payload, size_t length)> WebSocketServerEvent;
+
+    explicit WebSocketsServer(uint16_t port, const String &origin = "", const String &protocol = "arduino");
+    ~WebSocketsServer();
+
+    void begin() { _started = true; }
+    void loop();
+    void onEvent(WebSocketServerEvent cbEvent) { _cbEvent = cbEvent; }
+
+    bool sendTXT(uint8_t num, const char *payload, size_t length = 0, bool headerToPayload = false);
+    bool broadcastTXT(const char *payload, size_t length = 0, bool headerToPayload = false);
+    bool sendBIN(uint8_t num, const uint8_t *payload, size_t length, bool headerToPayload = false);
+    uint8_t connectedClients(bool ping = false);
+    void disconnect(uint8_t num);
+
+    uint16_t port() const { return _port; }
+
+    struct Event
+    {
+        uint8_t num;
+        WStype_t type;
+        std::vector<uint8_t> payload;
+    };
+    void enqueue(const Event &event) { _pending.push_back(event); }
+    int allocateClient();
+
+private:
+    uint16_t _port;
+    bool _started = false;
+    bool _connected[WEBSOCKETS_SERVER_CLIENT_MAX] = {};
+    WebSocketServerEvent _cbEvent;
+    std::deque<Event> _pending;
+};
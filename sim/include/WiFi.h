@@ -0,0 +1,82 @@
+#pragma once
+#include <Arduino.h>
+#include "IPAddress.h"
+#include "WiFiClient.h"
+#include "WiFiServer.h"
+
+typedef enum
+{
+    WL_NO_SHIELD = 255,
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum
+{
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3
+} wifi_mode_t;
+
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+
+// 模拟 STA/AP：begin() 之后经过 SIM_WIFI_CONNECT_MS 毫秒进入已连接状态。
+// 其中 SIM_WIFI_SCAN_MS 为扫描时间，begin() 同时给出信道和 BSSID 时跳过；
+// SIM_WIFI_DHCP_MS 为 DHCP 时间，config() 设置了静态 IP 时跳过。
+// SIM_WIFI_SSID 为逗号分隔的可见网络列表，未设置时任何 SSID 都能连接但扫描结果为空
+class WiFiClass
+{
+public:
+    bool mode(wifi_mode_t m);
+    wifi_mode_t getMode() const { return _mode; }
+    wl_status_t begin(const char *ssid, const char *passphrase = nullptr, int32_t channel = 0,
+                      const uint8_t *bssid = nullptr, bool connect = true);
+    wl_status_t status();
+    bool disconnect(bool wifioff = false, bool eraseap = false);
+    bool isConnected() { return status() == WL_CONNECTED; }
+    bool config(IPAddress local_ip, IPAddress gateway, IPAddress subnet, IPAddress dns1 = IPAddress());
+    IPAddress localIP();
+    IPAddress gatewayIP() { return isConnected() ? IPAddress(192, 168, 1, 1) : IPAddress(); }
+    IPAddress subnetMask() { return isConnected() ? IPAddress(255, 255, 255, 0) : IPAddress(); }
+    IPAddress dnsIP(uint8_t index = 0) { return gatewayIP(); }
+    uint8_t *BSSID() { return isConnected() ? _bssid : nullptr; }
+    int32_t channel() { return isConnected() ? _channel : 0; }
+
+    int16_t scanNetworks(bool async = false);
+    int16_t scanComplete();
+    void scanDelete() { _scanCount = WIFI_SCAN_FAILED; }
+    String SSID(uint8_t index);
+    int32_t RSSI(uint8_t index);
+    uint8_t *BSSID(uint8_t index);
+    int32_t channel(uint8_t index);
+    String SSID() const { return _ssid; }
+    int32_t RSSI() { return isConnected() ? -55 : 0; }
+    String macAddress() const { return "24:0A:C4:00:00:01"; }
+
+    bool softAP(const char *ssid, const char *passphrase = nullptr, int channel = 1,
+                int ssid_hidden = 0, int max_connection = 4);
+    IPAddress softAPIP() const { return IPAddress(192, 168, 4, 1); }
+
+private:
+    wifi_mode_t _mode = WIFI_OFF;
+    String _ssid;
+    bool _connecting = false;
+    bool _connected = false;
+    bool _targetValid = true; // begin() 指定的信道/BSSID 与实际接入点一致
+    unsigned long _connectAt = 0;
+    uint8_t _bssid[6] = {};
+    int32_t _channel = 0;
+    uint32_t _staticIP = 0;
+    int16_t _scanCount = WIFI_SCAN_FAILED;
+    unsigned long _scanDoneAt = 0;
+    uint8_t _scanBssid[6] = {};
+};
+
+extern WiFiClass WiFi;
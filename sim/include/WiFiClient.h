@@ -0,0 +1,35 @@
+#pragma once
+#include <memory>
+#include "Client.h"
+
+namespace sim
+{
+    struct Socket;
+}
+
+// 模拟网络连接：对外连接回环到进程内的 MQTT broker 替身
+class WiFiClient : public Client
+{
+public:
+    WiFiClient() {}
+    explicit WiFiClient(std::shared_ptr<sim::Socket> socket) : _socket(socket) {}
+
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char *host, uint16_t port) override;
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t *buf, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int read(uint8_t *buf, size_t size) override;
+    int peek() override;
+    void flush() override {}
+    void stop() override;
+    uint8_t connected() override;
+    operator bool() override { return connected(); }
+    void setNoDelay(bool) {}
+
+private:
+    std::shared_ptr<sim::Socket> _socket;
+    bool _outbound = false; // 主动发起的连接在 WiFi 断开时失效，服务端接受的连接不受影响
+};
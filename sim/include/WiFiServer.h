@@ -0,0 +1,28 @@
+#pragma once
+#include <deque>
+#include <memory>
+#include "WiFiClient.h"
+
+// 模拟 WiFiServer：接受 sim::httpRequest() 注入的进程内连接；
+// 端口 80 的服务器在设置 SIM_HTTP_PORT 时还会监听本机 TCP 端口，供外部压测工具连接
+class WiFiServer
+{
+public:
+    explicit WiFiServer(uint16_t port = 80, uint8_t maxClients = 4);
+    ~WiFiServer();
+
+    void begin(uint16_t port = 0);
+    void end();
+    WiFiClient accept();
+    WiFiClient available() { return accept(); }
+    void setNoDelay(bool) {}
+
+    uint16_t port() const { return _port; }
+    void enqueue(std::shared_ptr<sim::Socket> socket) { _pending.push_back(socket); }
+
+private:
+    uint16_t _port;
+    bool _started = false;
+    int _listenFd = -1;
+    std::deque<std::shared_ptr<sim::Socket>> _pending;
+};
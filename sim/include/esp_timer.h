@@ -0,0 +1,5 @@
+#pragma once
+// esp_timer 替身：与 micros() 使用同一个虚拟时钟
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
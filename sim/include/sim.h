@@ -0,0 +1,84 @@
+#pragma once
+// 主机模拟环境的控制接口：注入网络流量、控制链路状态、读取记录
+#include <Arduino.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sim
+{
+    // 连接对端，WiFiClient 通过它收发数据
+    struct Socket
+    {
+        virtual ~Socket() {}
+        virtual size_t send(const uint8_t *data, size_t size) = 0;
+        virtual int available() = 0;
+        virtual int read(uint8_t *buf, size_t size) = 0;
+        virtual int peek() = 0;
+        virtual bool connected() = 0;
+        virtual void close() = 0;
+    };
+
+    struct ServoSample
+    {
+        unsigned long timeUs;
+        int pin;
+        int pulseUs;
+    };
+
+    // 时钟：delay() 不睡眠，只推进虚拟时间偏移
+    void advanceClock(unsigned long ms);
+
+    // 进程内 MQTT broker 替身
+    std::shared_ptr<Socket> brokerConnect(const char *host, uint16_t port);
+    void mqttPublish(const char *topic, const uint8_t *payload, size_t length);
+    void mqttPublish(const char *topic, const char *payload);
+    unsigned long mqttReceivedCount();  // 设备发出的 PUBLISH 数
+    unsigned long mqttDeliveredCount(); // 投递给设备的 PUBLISH 数
+    unsigned long mqttDeliveredBytes(); // 投递给设备的负载字节数
+    unsigned long mqttRedeliveredCount(); // SIM_MQTT_REDELIVER 产生的重复投递数
+    unsigned long mqttAckedCount();       // 设备回复的 PUBACK 数
+    unsigned long mqttDroppedCount();     // 设备读取过慢、超过 SIM_MQTT_QUEUE_BYTES 时 broker 丢弃的消息数
+
+    // MQTT 压测（脚本动作 storm），见 sim_storm.cpp
+    bool stormPlan(unsigned long at, const std::string &args, std::vector<std::pair<unsigned long, std::string>> &events);
+    void stormSend(const std::string &args);
+    void stormDevicePublish(const std::string &topic, const uint8_t *payload, size_t length);
+    void stormReport();
+
+    // 命令解码微基准（脚本动作 decodebench），见 sim_decode_bench.cpp
+    void decodeBench(const std::string &args);
+
+    // HTTP 请求注入
+    void httpRequest(const char *method, const char *uri, const char *body, int port = 80);
+    int lastHttpStatus();
+    const String &lastHttpBody();
+
+    // WebSocket 客户端注入，返回客户端编号
+    int wsOpen(uint16_t port = 81);
+    void wsSend(int num, bool binary, const uint8_t *data, size_t length, uint16_t port = 81);
+    void wsClose(int num, uint16_t port = 81);
+    unsigned long wsSentCount(); // 设备发出的消息数
+    unsigned long wsSentBytes();
+
+    // 链路与引脚
+    void setWiFiLink(bool up);
+    bool wifiLinkUp();
+    void setPin(uint8_t pin, int level);
+
+    // 记录
+    const std::vector<ServoSample> &servoLog();
+    unsigned long pixelShowCount();
+    unsigned long flashEraseCount();      // config 分区擦除的扇区数
+    unsigned long flashProgrammedBytes(); // config 分区写入的字节数
+    // 分区镜像保存在 SIM_FLASH_FILE 中（默认 sim_flash.bin）
+    void flashReload();                  // 重新从文件读取镜像，相当于重启
+    void flashErase();                   // 删除文件，分区恢复为全 0xFF
+    void flashCutPowerAfter(long bytes); // 再写入 bytes 字节后掉电，之后的写入被丢弃，直到 flashReload()
+
+    unsigned long heapAllocationCount();
+
+    bool quiet();
+    void requestExit();
+}
@@ -0,0 +1,551 @@
+// 模拟 Arduino 核心：时钟、引脚、堆统计、串口以及主机上的 main()
+#include <Arduino.h>
+#include <sim.h>
+#include <binary_protocol.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <malloc.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdarg.h>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+namespace
+{
+    const uint32_t SIM_HEAP_SIZE = 320 * 1024;
+
+    std::atomic<unsigned long long> clockOffsetUs{0};
+    std::atomic<size_t> heapUsed{0};
+    std::atomic<size_t> heapPeak{0};
+    std::atomic<unsigned long> heapAllocations{0};
+    int pinLevels[64];
+    bool quietMode = false;
+    bool exitRequested = false;
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    void trackAlloc(void *p)
+    {
+        if (!p)
+            return;
+        size_t used = heapUsed += malloc_usable_size(p);
+        heapAllocations++;
+        size_t peak = heapPeak.load();
+        while (used > peak && !heapPeak.compare_exchange_weak(peak, used))
+        {
+        }
+    }
+
+    void trackFree(void *p)
+    {
+        if (p)
+            heapUsed -= malloc_usable_size(p);
+    }
+}
+
+// 替换 C 库的分配函数，ArduinoJson 默认分配器走 malloc/realloc，operator new 也落在这里，
+// 所有堆分配都计入 heapAllocationCount()。消毒器（-fsanitize=address/thread）自己接管 malloc，
+// 这时只统计 operator new
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define SIM_TRACK_MALLOC 0
+#else
+#define SIM_TRACK_MALLOC 1
+#endif
+
+#if SIM_TRACK_MALLOC
+extern "C"
+{
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t count, size_t size);
+    void *__libc_realloc(void *p, size_t size);
+    void *__libc_memalign(size_t alignment, size_t size);
+    void __libc_free(void *p);
+
+    void *malloc(size_t size)
+    {
+        void *p = __libc_malloc(size);
+        trackAlloc(p);
+        return p;
+    }
+
+    void *calloc(size_t count, size_t size)
+    {
+        void *p = __libc_calloc(count, size);
+        trackAlloc(p);
+        return p;
+    }
+
+    void *realloc(void *p, size_t size)
+    {
+        if (!p)
+            return malloc(size);
+        size_t old = malloc_usable_size(p);
+        void *q = __libc_realloc(p, size);
+        if (q || size == 0)
+            heapUsed -= old; // 原内存块已释放或被移动
+        trackAlloc(q);
+        return q;
+    }
+
+    void *memalign(size_t alignment, size_t size)
+    {
+        void *p = __libc_memalign(alignment, size);
+        trackAlloc(p);
+        return p;
+    }
+
+    void *aligned_alloc(size_t alignment, size_t size) { return memalign(alignment, size); }
+
+    int posix_memalign(void **result, size_t alignment, size_t size)
+    {
+        void *p = memalign(alignment, size);
+        if (!p)
+            return ENOMEM;
+        *result = p;
+        return 0;
+    }
+
+    void free(void *p)
+    {
+        trackFree(p);
+        __libc_free(p);
+    }
+}
+#endif
+
+void *operator new(size_t size)
+{
+    void *p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+#if !SIM_TRACK_MALLOC
+    trackAlloc(p);
+#endif
+    return p;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+
+void operator delete(void *p) noexcept
+{
+#if !SIM_TRACK_MALLOC
+    trackFree(p);
+#endif
+    free(p);
+}
+
+void operator delete[](void *p) noexcept { operator delete(p); }
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+void operator delete[](void *p, size_t) noexcept { operator delete(p); }
+
+unsigned long micros()
+{
+    auto elapsed = std::chrono::steady_clock::now() - startTime;
+    return (unsigned long)(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() + clockOffsetUs.load());
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return micros();
+}
+
+unsigned long millis()
+{
+    return micros() / 1000;
+}
+
+void delay(unsigned long ms)
+{
+    clockOffsetUs += (unsigned long long)ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    clockOffsetUs += us;
+}
+
+void yield() {}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (pin < 64 && mode == INPUT_PULLUP)
+        pinLevels[pin] = HIGH;
+}
+
+int digitalRead(uint8_t pin)
+{
+    return pin < 64 ? pinLevels[pin] : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    if (pin < 64)
+        pinLevels[pin] = val;
+}
+
+long random(long howbig)
+{
+    return howbig > 0 ? ::random() % howbig : 0;
+}
+
+long random(long howsmall, long howbig)
+{
+    return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall);
+}
+
+void randomSeed(unsigned long seed)
+{
+    if (seed != 0)
+        srandom(seed);
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+    if (in_max == in_min)
+        return out_min;
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+void EspClass::restart()
+{
+    fprintf(stderr, "[sim] ESP.restart()\n");
+    exit(0);
+}
+
+esp_reset_reason_t esp_reset_reason(void)
+{
+    const char *reason = getenv("SIM_RESET_REASON");
+    if (!reason || strcmp(reason, "poweron") == 0)
+        return ESP_RST_POWERON;
+    if (strcmp(reason, "brownout") == 0)
+        return ESP_RST_BROWNOUT;
+    if (strcmp(reason, "software") == 0)
+        return ESP_RST_SW;
+    if (strcmp(reason, "panic") == 0)
+        return ESP_RST_PANIC;
+    return ESP_RST_UNKNOWN;
+}
+
+uint32_t EspClass::getFreeHeap()
+{
+    size_t used = heapUsed.load();
+    return used < SIM_HEAP_SIZE ? SIM_HEAP_SIZE - used : 0;
+}
+
+uint32_t EspClass::getMinFreeHeap()
+{
+    size_t peak = heapPeak.load();
+    return peak < SIM_HEAP_SIZE ? SIM_HEAP_SIZE - peak : 0;
+}
+
+uint32_t EspClass::getHeapSize()
+{
+    return SIM_HEAP_SIZE;
+}
+
+uint32_t EspClass::getCycleCount()
+{
+    // 按 240MHz 折算
+    return (uint32_t)((unsigned long long)micros() * 240);
+}
+
+void HardwareSerial::begin(unsigned long baud) {}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    if (!quietMode)
+        fputc(c, stdout);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    if (!quietMode)
+        fwrite(buffer, 1, size, stdout);
+    return size;
+}
+
+namespace sim
+{
+    void advanceClock(unsigned long ms) { delay(ms); }
+
+    void setPin(uint8_t pin, int level)
+    {
+        if (pin < 64)
+            pinLevels[pin] = level;
+    }
+
+    bool quiet() { return quietMode; }
+    void requestExit() { exitRequested = true; }
+
+    unsigned long heapAllocationCount() { return heapAllocations.load(); }
+}
+
+// ---------------------------------------------------------------------------
+// 脚本驱动
+//
+// 每行一个事件：<时间ms> <动作> ...
+//   100 mqtt esp32/servo {"command":"position","position":90,"pwd":"..."}
+//   200 http POST /control {"command":"start"}
+//   250 ws open                     打开一个 WebSocket 客户端（编号按顺序从 0 开始）
+//   260 ws bin 0 01002823           客户端 0 发送十六进制二进制帧
+//   270 ws text 0 hello | ws close 0
+//   300 wifi down|up
+//   400 pin 0 0
+//   150 mqttbin esp32/servo/bin 3 0 9000 0 1 <密码>  二进制帧：opcode channel position flags seq（0 不回执）
+//   500 repeat 1000 1 mqtt esp32/servo {...}   重复 1000 次，间隔 1ms（0 为突发）
+//   1000 storm 5000 2000 steady 80/15/5 <密码>  MQTT 压测，见 sim_storm.cpp
+//   0 decodebench 200000 <密码>              二进制与 JSON 解码各执行 200000 次并计时，见 sim_decode_bench.cpp
+//   9000 quit
+// ---------------------------------------------------------------------------
+namespace
+{
+    struct ScriptEvent
+    {
+        unsigned long at;
+        std::string action;
+        std::string args;
+    };
+
+    std::vector<ScriptEvent> script;
+    size_t scriptCursor = 0;
+
+    std::string nextToken(std::istringstream &in)
+    {
+        std::string token;
+        in >> token;
+        return token;
+    }
+
+    std::string rest(std::istringstream &in)
+    {
+        std::string r;
+        std::getline(in, r);
+        size_t start = r.find_first_not_of(' ');
+        return start == std::string::npos ? std::string() : r.substr(start);
+    }
+
+    void loadScript(const char *path)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            fprintf(stderr, "[sim] cannot open script %s\n", path);
+            exit(1);
+        }
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (line.empty() || line[0] == '#')
+                continue;
+            std::istringstream in(line);
+            unsigned long at = std::stoul(nextToken(in));
+            std::string action = nextToken(in);
+            if (action == "repeat")
+            {
+                unsigned long count = std::stoul(nextToken(in));
+                unsigned long interval = std::stoul(nextToken(in));
+                std::string inner = nextToken(in);
+                std::string args = rest(in);
+                for (unsigned long i = 0; i < count; i++)
+                    script.push_back({at + i * interval, inner, args});
+            }
+            else if (action == "storm")
+            {
+                std::vector<std::pair<unsigned long, std::string>> events;
+                sim::stormPlan(at, rest(in), events);
+                for (auto &event : events)
+                    script.push_back({event.first, "stormmsg", event.second});
+            }
+            else
+            {
+                script.push_back({at, action, rest(in)});
+            }
+        }
+        std::stable_sort(script.begin(), script.end(),
+                         [](const ScriptEvent &a, const ScriptEvent &b)
+                         { return a.at < b.at; });
+    }
+
+    void runEvent(const ScriptEvent &event)
+    {
+        std::istringstream in(event.args);
+        if (event.action == "mqtt")
+        {
+            std::string topic = nextToken(in);
+            std::string payload = rest(in);
+            sim::mqttPublish(topic.c_str(), (const uint8_t *)payload.data(), payload.size());
+        }
+        else if (event.action == "mqttbin")
+        {
+            std::string topic = nextToken(in);
+            BinaryFrame frame;
+            frame.opcode = std::stoi(nextToken(in));
+            frame.channel = std::stoi(nextToken(in));
+            frame.position = std::stoi(nextToken(in));
+            frame.flags = std::stoi(nextToken(in));
+            frame.sequence = std::stoi(nextToken(in));
+            std::string password = nextToken(in);
+            uint8_t payload[BINARY_FRAME_SIZE];
+            encodeBinaryFrame(frame, password.c_str(), payload);
+            sim::mqttPublish(topic.c_str(), payload, sizeof(payload));
+        }
+        else if (event.action == "stormmsg")
+        {
+            sim::stormSend(event.args);
+        }
+        else if (event.action == "decodebench")
+        {
+            sim::decodeBench(event.args);
+        }
+        else if (event.action == "http")
+        {
+            std::string method = nextToken(in);
+            std::string uri = nextToken(in);
+            std::string body = rest(in);
+            sim::httpRequest(method.c_str(), uri.c_str(), body.c_str());
+        }
+        else if (event.action == "ws")
+        {
+            std::string op = nextToken(in);
+            if (op == "open")
+            {
+                sim::wsOpen();
+                return;
+            }
+            int num = std::stoi(nextToken(in));
+            if (op == "close")
+            {
+                sim::wsClose(num);
+            }
+            else if (op == "bin")
+            {
+                std::string hex = nextToken(in);
+                std::vector<uint8_t> data;
+                for (size_t i = 0; i + 1 < hex.size(); i += 2)
+                    data.push_back((uint8_t)std::stoi(hex.substr(i, 2), nullptr, 16));
+                sim::wsSend(num, true, data.data(), data.size());
+            }
+            else
+            {
+                std::string text = rest(in);
+                sim::wsSend(num, false, (const uint8_t *)text.data(), text.size());
+            }
+        }
+        else if (event.action == "wifi")
+        {
+            sim::setWiFiLink(nextToken(in) == "up");
+        }
+        else if (event.action == "pin")
+        {
+            int pin = std::stoi(nextToken(in));
+            sim::setPin(pin, std::stoi(nextToken(in)));
+        }
+        else if (event.action == "quit")
+        {
+            exitRequested = true;
+        }
+        else
+        {
+            fprintf(stderr, "[sim] unknown script action: %s\n", event.action.c_str());
+        }
+    }
+
+    // loop() 耗时统计，按 2 的幂分桶
+    const int LATENCY_BUCKETS = 32;
+    unsigned long long loopCount = 0;
+    unsigned long long loopTotalNs = 0;
+    unsigned long long loopMaxNs = 0;
+    unsigned long long loopHistogram[LATENCY_BUCKETS];
+
+    void recordLoop(unsigned long long ns)
+    {
+        loopCount++;
+        loopTotalNs += ns;
+        loopMaxNs = std::max(loopMaxNs, ns);
+        int bucket = 0;
+        while (bucket < LATENCY_BUCKETS - 1 && (1ULL << (bucket + 1)) <= ns)
+            bucket++;
+        loopHistogram[bucket]++;
+    }
+
+    unsigned long long loopPercentileNs(double p)
+    {
+        unsigned long long target = (unsigned long long)(loopCount * p);
+        unsigned long long seen = 0;
+        for (int i = 0; i < LATENCY_BUCKETS; i++)
+        {
+            seen += loopHistogram[i];
+            if (seen > target)
+                return 1ULL << (i + 1);
+        }
+        return loopMaxNs;
+    }
+
+    void report()
+    {
+        fprintf(stderr, "[sim] virtual time      %lu ms\n", millis());
+        fprintf(stderr, "[sim] loop() calls      %llu\n", loopCount);
+        if (loopCount)
+        {
+            fprintf(stderr, "[sim] loop() mean       %.2f us\n", loopTotalNs / 1000.0 / loopCount);
+            fprintf(stderr, "[sim] loop() p50 <=     %.2f us\n", loopPercentileNs(0.50) / 1000.0);
+            fprintf(stderr, "[sim] loop() p99 <=     %.2f us\n", loopPercentileNs(0.99) / 1000.0);
+            fprintf(stderr, "[sim] loop() max        %.2f us\n", loopMaxNs / 1000.0);
+        }
+        fprintf(stderr, "[sim] script events     %zu/%zu\n", scriptCursor, script.size());
+        fprintf(stderr, "[sim] mqtt published    %lu\n", sim::mqttReceivedCount());
+        fprintf(stderr, "[sim] servo writes      %zu\n", sim::servoLog().size());
+        fprintf(stderr, "[sim] pixel show()      %lu\n", sim::pixelShowCount());
+        fprintf(stderr, "[sim] flash             %lu sector erases, %lu bytes programmed\n", sim::flashEraseCount(), sim::flashProgrammedBytes());
+        fprintf(stderr, "[sim] mqtt delivered    %lu (%lu payload bytes)\n", sim::mqttDeliveredCount(), sim::mqttDeliveredBytes());
+        fprintf(stderr, "[sim] mqtt puback       %lu (%lu redelivered)\n", sim::mqttAckedCount(), sim::mqttRedeliveredCount());
+        fprintf(stderr, "[sim] mqtt dropped      %lu\n", sim::mqttDroppedCount());
+        fprintf(stderr, "[sim] ws sent           %lu (%lu bytes)\n", sim::wsSentCount(), sim::wsSentBytes());
+        fprintf(stderr, "[sim] heap peak         %zu bytes\n", heapPeak.load());
+        fprintf(stderr, "[sim] heap allocations  %lu\n", heapAllocations.load());
+        sim::stormReport();
+    }
+}
+
+// 单元测试（pio test -e native）由测试自己提供 main()
+#ifndef PIO_UNIT_TESTING
+int main(int argc, char **argv)
+{
+    const char *quiet = getenv("SIM_QUIET");
+    quietMode = quiet && quiet[0] == '1';
+    pinLevels[0] = HIGH; // BOOT 按键默认上拉
+
+    const char *scriptPath = argc > 1 ? argv[1] : getenv("SIM_SCRIPT");
+    if (scriptPath)
+        loadScript(scriptPath);
+
+    const char *duration = getenv("SIM_DURATION_MS");
+    unsigned long durationMs = duration ? strtoul(duration, nullptr, 10) : 0;
+
+    atexit(report);
+    setup();
+
+    while (!exitRequested && (durationMs == 0 || millis() < durationMs))
+    {
+        unsigned long now = millis();
+        while (scriptCursor < script.size() && script[scriptCursor].at <= now)
+            runEvent(script[scriptCursor++]);
+
+        auto begin = std::chrono::steady_clock::now();
+        loop();
+        auto end = std::chrono::steady_clock::now();
+        recordLoop(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+    }
+    return 0;
+}
+#endif
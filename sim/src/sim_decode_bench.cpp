@@ -0,0 +1,99 @@
+// 命令解码微基准：脚本动作 decodebench 在同一进程内对同一条 position 命令分别计时
+//   二进制：decodeBinaryFrame()（含 SipHash 认证标签校验）
+//   JSON：  deserializeJson()（与 MQTT 路径相同的过滤器和静态内存池）+ commandRouter.parse() + 密码比较
+// 不经过 broker、PubSubClient 和舵机任务，只比较解码本身；bench_json.txt / bench_binary.txt 测的是整条链路。
+//
+//   <时间ms> decodebench <次数> <密码>
+//   0 decodebench 200000 12345678
+#include <sim.h>
+#include <config.h>
+#include <command_router.h>
+#include <binary_protocol.h>
+#include <static_allocator.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace
+{
+    // 防止编译器把循环体当作无用代码删掉
+    volatile uint32_t sink;
+
+    double elapsedNs(std::chrono::steady_clock::time_point start, unsigned long count)
+    {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / count;
+    }
+
+    double benchBinary(unsigned long count, const char *password)
+    {
+        BinaryFrame frame = {};
+        frame.opcode = BIN_OP_POSITION;
+        frame.position = 9000;
+        frame.sequence = 1;
+        uint8_t payload[BINARY_FRAME_SIZE];
+        encodeBinaryFrame(frame, password, payload);
+
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned long i = 0; i < count; i++)
+        {
+            BinaryFrame decoded;
+            if (decodeBinaryFrame(payload, sizeof(payload), password, decoded) == BIN_OK)
+            {
+                sink = decoded.position;
+            }
+        }
+        return elapsedNs(start, count);
+    }
+
+    double benchJson(unsigned long count, const char *password)
+    {
+        static StaticPoolAllocator<MQTT_JSON_POOL_SIZE> allocator;
+        static JsonDocument doc(&allocator);
+        JsonDocument filter;
+        const char *fields[] = {"command", "position", "restore", "channel", "group", "pwd", "frames", "loops", "seq"};
+        for (const char *field : fields)
+        {
+            filter[field] = true;
+        }
+        char payload[128];
+        int length = snprintf(payload, sizeof(payload),
+                              "{\"command\":\"position\",\"position\":90,\"channel\":0,\"seq\":1,\"pwd\":\"%s\"}", password);
+
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned long i = 0; i < count; i++)
+        {
+            if (deserializeJson(doc, (const uint8_t *)payload, length, DeserializationOption::Filter(filter)))
+            {
+                continue;
+            }
+            Command command;
+            const char *pwd = doc["pwd"];
+            if (commandRouter.parse(doc, command) == COMMAND_OK && pwd && strcmp(pwd, password) == 0)
+            {
+                sink = command.position;
+            }
+        }
+        return elapsedNs(start, count);
+    }
+}
+
+namespace sim
+{
+    void decodeBench(const std::string &args)
+    {
+        char password[64] = "";
+        unsigned long count = 0;
+        if (sscanf(args.c_str(), "%lu %63s", &count, password) != 2 || count == 0)
+        {
+            fprintf(stderr, "[sim] decodebench: expected <count> <password>\n");
+            return;
+        }
+        double binaryNs = benchBinary(count, password);
+        double jsonNs = benchJson(count, password);
+        fprintf(stderr, "[sim] decode binary     %.0f ns/frame (%lu frames)\n", binaryNs, count);
+        fprintf(stderr, "[sim] decode json       %.0f ns/frame (%lu frames)\n", jsonNs, count);
+        fprintf(stderr, "[sim] decode json/bin   %.1fx\n", jsonNs / binaryNs);
+    }
+}
@@ -0,0 +1,89 @@
+// 模拟外设：文件 EEPROM、记录型舵机、NeoPixel
+#include <EEPROM.h>
+#include <ESP32Servo.h>
+#include <Adafruit_NeoPixel.h>
+#include <sim.h>
+#include <stdio.h>
+
+EEPROMClass EEPROM;
+
+namespace
+{
+    const size_t SERVO_LOG_LIMIT = 1 << 20;
+
+    std::vector<sim::ServoSample> servoSamples;
+    unsigned long pixelShows = 0;
+
+    const char *eepromPath()
+    {
+        const char *path = getenv("SIM_EEPROM_FILE");
+        return path ? path : "sim_eeprom.bin";
+    }
+}
+
+namespace sim
+{
+    const std::vector<ServoSample> &servoLog() { return servoSamples; }
+    unsigned long pixelShowCount() { return pixelShows; }
+}
+
+bool EEPROMClass::begin(size_t size)
+{
+    _data.assign(size, 0);
+    FILE *file = fopen(eepromPath(), "rb");
+    if (file)
+    {
+        size_t n = fread(_data.data(), 1, size, file);
+        (void)n;
+        fclose(file);
+    }
+    return true;
+}
+
+bool EEPROMClass::commit()
+{
+    FILE *file = fopen(eepromPath(), "wb");
+    if (!file)
+        return false;
+    bool ok = fwrite(_data.data(), 1, _data.size(), file) == _data.size();
+    fclose(file);
+    return ok;
+}
+
+int Servo::attach(int pin, int min, int max)
+{
+    _pin = pin;
+    _min = min;
+    _max = max;
+    return pin;
+}
+
+void Servo::write(int value)
+{
+    // 与 ESP32Servo 一致：小于最小脉宽的数值视为角度
+    if (value < _min)
+    {
+        value = constrain(value, 0, 180);
+        value = map(value, 0, 180, _min, _max);
+    }
+    writeMicroseconds(value);
+}
+
+void Servo::writeMicroseconds(int value)
+{
+    if (!attached())
+        return;
+    _us = constrain(value, _min, _max);
+    if (servoSamples.size() < SERVO_LOG_LIMIT)
+        servoSamples.push_back({micros(), _pin, _us});
+}
+
+int Servo::read() const
+{
+    return map(_us + 1, _min, _max, 0, 180);
+}
+
+void Adafruit_NeoPixel::show()
+{
+    pixelShows++;
+}
@@ -0,0 +1,138 @@
+// 模拟 SPI 闪存上的 config 数据分区，文件即分区镜像
+#include <esp_partition.h>
+#include <sim.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+    const uint32_t CONFIG_PARTITION_SIZE = 0x4000; // 与 partitions.csv 一致
+
+    esp_partition_t configPartition = {ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)0x40, 0x290000,
+                                       CONFIG_PARTITION_SIZE, "config", false};
+    std::vector<uint8_t> image;
+    bool loaded = false;
+    unsigned long erases = 0;
+    unsigned long programmed = 0;
+    long tearAt = -1;
+    bool tearExits = true; // SIM_FLASH_TEAR_AT 掉电时退出进程；测试中改为丢弃之后的写入
+
+    const char *flashPath()
+    {
+        const char *path = getenv("SIM_FLASH_FILE");
+        return path ? path : "sim_flash.bin";
+    }
+
+    void load()
+    {
+        if (loaded)
+            return;
+        loaded = true;
+        image.assign(CONFIG_PARTITION_SIZE, 0xFF);
+        FILE *file = fopen(flashPath(), "rb");
+        if (file)
+        {
+            size_t n = fread(image.data(), 1, image.size(), file);
+            (void)n;
+            fclose(file);
+        }
+        const char *tear = getenv("SIM_FLASH_TEAR_AT");
+        tearAt = tear ? atol(tear) : -1;
+    }
+
+    void save()
+    {
+        FILE *file = fopen(flashPath(), "wb");
+        if (!file)
+            return;
+        size_t n = fwrite(image.data(), 1, image.size(), file);
+        (void)n;
+        fclose(file);
+    }
+
+    bool inRange(const esp_partition_t *partition, size_t offset, size_t size)
+    {
+        return partition == &configPartition && offset <= partition->size && size <= partition->size - offset;
+    }
+}
+
+namespace sim
+{
+    unsigned long flashEraseCount() { return erases; }
+    unsigned long flashProgrammedBytes() { return programmed; }
+
+    void flashReload()
+    {
+        loaded = false;
+        load();
+        tearAt = -1;
+    }
+
+    void flashErase()
+    {
+        remove(flashPath());
+        flashReload();
+    }
+
+    void flashCutPowerAfter(long bytes)
+    {
+        load();
+        tearAt = bytes < 0 ? -1 : (long)programmed + bytes;
+        tearExits = false;
+    }
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype, const char *label)
+{
+    if (type != ESP_PARTITION_TYPE_DATA || (label && strcmp(label, configPartition.label) != 0))
+        return nullptr;
+    if (subtype != ESP_PARTITION_SUBTYPE_ANY && subtype != configPartition.subtype)
+        return nullptr;
+    load();
+    return &configPartition;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size)
+{
+    if (!inRange(partition, src_offset, size))
+        return ESP_ERR_INVALID_SIZE;
+    memcpy(dst, image.data() + src_offset, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size)
+{
+    if (!inRange(partition, dst_offset, size))
+        return ESP_ERR_INVALID_SIZE;
+    const uint8_t *bytes = (const uint8_t *)src;
+    for (size_t i = 0; i < size; i++)
+    {
+        if (tearAt >= 0 && (long)programmed >= tearAt)
+        {
+            save();
+            if (!tearExits)
+                return ESP_FAIL;
+            fprintf(stderr, "[sim] flash power cut after %lu bytes\n", programmed);
+            _exit(3);
+        }
+        image[dst_offset + i] &= bytes[i]; // NOR：只能把 1 写成 0
+        programmed++;
+    }
+    save();
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size)
+{
+    if (!inRange(partition, offset, size) || offset % SPI_FLASH_SEC_SIZE || size % SPI_FLASH_SEC_SIZE)
+        return ESP_ERR_INVALID_ARG;
+    if (!tearExits && tearAt >= 0 && (long)programmed >= tearAt)
+        return ESP_FAIL;
+    memset(image.data() + offset, 0xFF, size);
+    erases += size / SPI_FLASH_SEC_SIZE;
+    save();
+    return ESP_OK;
+}
@@ -0,0 +1,75 @@
+// FreeRTOS 任务替身：每个任务一个分离线程。按虚拟时钟等待，进程退出时任务停在下一次延时处
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace
+{
+    std::atomic<bool> stopping{false};
+    std::atomic<int> runningTasks{0};
+
+    void stopTasks()
+    {
+        stopping = true;
+        // 等待所有任务停到延时点，之后再析构全局对象
+        for (int i = 0; i < 100 && runningTasks.load() > 0; i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    void park()
+    {
+        runningTasks--;
+        for (;;)
+            std::this_thread::sleep_for(std::chrono::hours(1));
+    }
+
+    // 实际睡眠直到虚拟时钟到达 wake；主线程 delay() 推进的时间偏移也会被计入
+    void sleepUntil(TickType_t wake)
+    {
+        for (;;)
+        {
+            if (stopping)
+                park();
+            int32_t remaining = (int32_t)(wake - xTaskGetTickCount());
+            if (remaining <= 0)
+                return;
+            std::this_thread::sleep_for(std::chrono::microseconds(remaining > 1 ? 1000 : 200));
+        }
+    }
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char *name, uint32_t stackDepth, void *parameters,
+                                   UBaseType_t priority, TaskHandle_t *createdTask, BaseType_t coreId)
+{
+    static bool registered = false;
+    if (!registered)
+    {
+        registered = true;
+        atexit(stopTasks);
+    }
+    runningTasks++;
+    std::thread thread(code, parameters);
+    if (createdTask)
+        *createdTask = (TaskHandle_t)(uintptr_t)runningTasks.load();
+    thread.detach();
+    return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    sleepUntil(xTaskGetTickCount() + ticks);
+}
+
+void vTaskDelayUntil(TickType_t *previousWakeTime, TickType_t timeIncrement)
+{
+    *previousWakeTime += timeIncrement;
+    sleepUntil(*previousWakeTime);
+}
+
+TickType_t xTaskGetTickCount()
+{
+    return (TickType_t)millis();
+}
@@ -0,0 +1,350 @@
+// 进程内 MQTT 3.1.1 broker 替身（支持 QoS0/QoS1 投递），替代 broker.emqx.io。
+// SIM_MQTT_REDELIVER=1 时每条 QoS1 消息带 DUP 标志再投递一次，模拟 PUBACK 丢失后的重复投递；
+// SIM_MQTT_ECHO=<主题过滤器> 时把设备发布到匹配主题的消息打印到 stderr；
+// 设备未读取的数据超过 SIM_MQTT_QUEUE_BYTES（默认 65536）时丢弃新消息，模拟 broker 对慢速订阅者的处理
+#include <sim.h>
+#include <deque>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    const uint8_t MQTT_CONNECT = 0x10;
+    const uint8_t MQTT_CONNACK = 0x20;
+    const uint8_t MQTT_PUBLISH = 0x30;
+    const uint8_t MQTT_PUBACK = 0x40;
+    const uint8_t MQTT_SUBSCRIBE = 0x80;
+    const uint8_t MQTT_SUBACK = 0x90;
+    const uint8_t MQTT_UNSUBSCRIBE = 0xA0;
+    const uint8_t MQTT_UNSUBACK = 0xB0;
+    const uint8_t MQTT_PINGREQ = 0xC0;
+    const uint8_t MQTT_PINGRESP = 0xD0;
+    const uint8_t MQTT_DISCONNECT = 0xE0;
+
+    bool topicMatches(const std::string &filter, const std::string &topic)
+    {
+        size_t f = 0, t = 0;
+        while (f < filter.size())
+        {
+            if (filter[f] == '#')
+                return true;
+            if (filter[f] == '+')
+            {
+                while (t < topic.size() && topic[t] != '/')
+                    t++;
+                f++;
+                continue;
+            }
+            if (t >= topic.size() || filter[f] != topic[t])
+                return false;
+            f++;
+            t++;
+        }
+        return t == topic.size();
+    }
+
+    bool envFlag(const char *name)
+    {
+        const char *value = getenv(name);
+        return value && value[0] == '1';
+    }
+
+    // 打印设备发布的消息，不可打印的负载按十六进制输出
+    void echoPublish(const std::string &topic, const uint8_t *payload, size_t length)
+    {
+        bool printable = true;
+        for (size_t i = 0; i < length; i++)
+            printable = printable && payload[i] >= 0x20 && payload[i] < 0x7F;
+        fprintf(stderr, "[sim] mqtt %lu %s ", millis(), topic.c_str());
+        for (size_t i = 0; i < length; i++)
+            fprintf(stderr, printable ? "%c" : "%02x", payload[i]);
+        fprintf(stderr, "\n");
+    }
+
+    template <typename Buffer>
+    void appendLength(Buffer &out, size_t length)
+    {
+        do
+        {
+            uint8_t digit = length % 128;
+            length /= 128;
+            if (length > 0)
+                digit |= 0x80;
+            out.push_back(digit);
+        } while (length > 0);
+    }
+
+    class BrokerSession : public sim::Socket
+    {
+    public:
+        size_t send(const uint8_t *data, size_t size) override
+        {
+            if (!_open)
+                return 0;
+            _in.insert(_in.end(), data, data + size);
+            while (processPacket())
+            {
+            }
+            return size;
+        }
+
+        int available() override { return _out.size(); }
+
+        int read(uint8_t *buf, size_t size) override
+        {
+            if (_out.empty())
+                return -1;
+            size_t n = std::min(size, _out.size());
+            std::copy(_out.begin(), _out.begin() + n, buf);
+            _out.erase(_out.begin(), _out.begin() + n);
+            return n;
+        }
+
+        int peek() override { return _out.empty() ? -1 : _out.front(); }
+        bool connected() override { return _open; }
+        void close() override
+        {
+            _open = false;
+            _subscriptions.clear();
+        }
+
+        void deliver(const std::string &topic, const uint8_t *payload, size_t length)
+        {
+            if (!_open || !_session)
+                return;
+            int qos = -1;
+            for (const auto &subscription : _subscriptions)
+                if (topicMatches(subscription.first, topic))
+                    qos = std::max(qos, (int)subscription.second);
+            if (qos < 0)
+                return;
+            static const char *limit = getenv("SIM_MQTT_QUEUE_BYTES");
+            static const size_t queueLimit = limit ? strtoul(limit, nullptr, 10) : 65536;
+            if (_out.size() >= queueLimit)
+            {
+                dropped++;
+                return;
+            }
+
+            std::vector<uint8_t> packet;
+            packet.push_back(MQTT_PUBLISH | (qos << 1));
+            appendLength(packet, 2 + topic.size() + (qos ? 2 : 0) + length);
+            packet.push_back(topic.size() >> 8);
+            packet.push_back(topic.size() & 0xFF);
+            packet.insert(packet.end(), topic.begin(), topic.end());
+            if (qos)
+            {
+                if (++_packetId == 0)
+                    _packetId = 1;
+                packet.push_back(_packetId >> 8);
+                packet.push_back(_packetId & 0xFF);
+            }
+            packet.insert(packet.end(), payload, payload + length);
+            _out.insert(_out.end(), packet.begin(), packet.end());
+            delivered++;
+            deliveredBytes += length;
+
+            static const bool redeliver = envFlag("SIM_MQTT_REDELIVER");
+            if (qos && redeliver)
+            {
+                packet[0] |= 0x08; // DUP
+                _out.insert(_out.end(), packet.begin(), packet.end());
+                redelivered++;
+            }
+        }
+
+        unsigned long published = 0;
+        unsigned long delivered = 0;
+        unsigned long deliveredBytes = 0;
+        unsigned long redelivered = 0;
+        unsigned long dropped = 0;
+        unsigned long acked = 0; // 设备回复的 PUBACK
+
+    private:
+        // 从输入缓冲中取出一个完整报文并处理，不完整时返回 false
+        bool processPacket()
+        {
+            if (_in.size() < 2)
+                return false;
+            size_t length = 0, multiplier = 1, pos = 1;
+            uint8_t digit;
+            do
+            {
+                if (pos >= _in.size())
+                    return false;
+                digit = _in[pos++];
+                length += (digit & 0x7F) * multiplier;
+                multiplier *= 128;
+            } while (digit & 0x80);
+            if (_in.size() < pos + length)
+                return false;
+
+            uint8_t header = _in[0];
+            uint8_t type = header & 0xF0;
+            std::vector<uint8_t> body(_in.begin() + pos, _in.begin() + pos + length);
+            _in.erase(_in.begin(), _in.begin() + pos + length);
+
+            switch (type)
+            {
+            case MQTT_CONNECT:
+                _session = true;
+                _out.insert(_out.end(), {MQTT_CONNACK, 0x02, 0x00, 0x00});
+                break;
+            case MQTT_SUBSCRIBE:
+            {
+                size_t i = 2;
+                std::vector<uint8_t> granted;
+                while (i + 2 <= body.size())
+                {
+                    size_t topicLength = (body[i] << 8) | body[i + 1];
+                    i += 2;
+                    uint8_t qos = std::min<uint8_t>(body[i + topicLength] & 0x03, 1);
+                    _subscriptions.emplace_back(std::string((const char *)&body[i], topicLength), qos);
+                    i += topicLength + 1;
+                    granted.push_back(qos);
+                }
+                _out.push_back(MQTT_SUBACK);
+                appendLength(_out, 2 + granted.size());
+                _out.insert(_out.end(), body.begin(), body.begin() + 2);
+                _out.insert(_out.end(), granted.begin(), granted.end());
+                break;
+            }
+            case MQTT_UNSUBSCRIBE:
+                _out.insert(_out.end(), {MQTT_UNSUBACK, 0x02, body[0], body[1]});
+                break;
+            case MQTT_PUBLISH:
+            {
+                published++;
+                if (body.size() < 2)
+                    break;
+                size_t topicLength = (body[0] << 8) | body[1];
+                size_t offset = 2 + topicLength + ((header & 0x06) ? 2 : 0);
+                if (offset > body.size())
+                    break;
+                std::string topic((const char *)&body[2], topicLength);
+                static const char *echo = getenv("SIM_MQTT_ECHO");
+                if (echo && topicMatches(echo, topic))
+                    echoPublish(topic, body.data() + offset, body.size() - offset);
+                sim::stormDevicePublish(topic, body.data() + offset, body.size() - offset);
+                break;
+            }
+            case MQTT_PUBACK:
+                acked++;
+                break;
+            case MQTT_PINGREQ:
+                _out.insert(_out.end(), {MQTT_PINGRESP, 0x00});
+                break;
+            case MQTT_DISCONNECT:
+                close();
+                break;
+            }
+            return true;
+        }
+
+        bool _open = true;
+        bool _session = false;
+        std::deque<uint8_t> _in;
+        std::deque<uint8_t> _out;
+        std::vector<std::pair<std::string, uint8_t>> _subscriptions; // 过滤器与授予的 QoS
+        uint16_t _packetId = 0;
+    };
+
+    std::vector<std::shared_ptr<BrokerSession>> sessions;
+    unsigned long closedPublished = 0;
+    unsigned long closedDelivered = 0;
+    unsigned long closedDeliveredBytes = 0;
+    unsigned long closedRedelivered = 0;
+    unsigned long closedAcked = 0;
+    unsigned long closedDropped = 0;
+}
+
+namespace sim
+{
+    std::shared_ptr<Socket> brokerConnect(const char *host, uint16_t port)
+    {
+        // 清理已关闭的会话
+        for (auto it = sessions.begin(); it != sessions.end();)
+        {
+            if (!(*it)->connected())
+            {
+                closedPublished += (*it)->published;
+                closedDelivered += (*it)->delivered;
+                closedDeliveredBytes += (*it)->deliveredBytes;
+                closedRedelivered += (*it)->redelivered;
+                closedAcked += (*it)->acked;
+                closedDropped += (*it)->dropped;
+                it = sessions.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        auto session = std::make_shared<BrokerSession>();
+        sessions.push_back(session);
+        return session;
+    }
+
+    void mqttPublish(const char *topic, const uint8_t *payload, size_t length)
+    {
+        std::string t(topic);
+        for (auto &session : sessions)
+            session->deliver(t, payload, length);
+    }
+
+    void mqttPublish(const char *topic, const char *payload)
+    {
+        mqttPublish(topic, (const uint8_t *)payload, strlen(payload));
+    }
+
+    unsigned long mqttDeliveredCount()
+    {
+        unsigned long total = closedDelivered;
+        for (auto &session : sessions)
+            total += session->delivered;
+        return total;
+    }
+
+    unsigned long mqttDeliveredBytes()
+    {
+        unsigned long total = closedDeliveredBytes;
+        for (auto &session : sessions)
+            total += session->deliveredBytes;
+        return total;
+    }
+
+    unsigned long mqttReceivedCount()
+    {
+        unsigned long total = closedPublished;
+        for (auto &session : sessions)
+            total += session->published;
+        return total;
+    }
+
+    unsigned long mqttRedeliveredCount()
+    {
+        unsigned long total = closedRedelivered;
+        for (auto &session : sessions)
+            total += session->redelivered;
+        return total;
+    }
+
+    unsigned long mqttAckedCount()
+    {
+        unsigned long total = closedAcked;
+        for (auto &session : sessions)
+            total += session->acked;
+        return total;
+    }
+
+    unsigned long mqttDroppedCount()
+    {
+        unsigned long total = closedDropped;
+        for (auto &session : sessions)
+            total += session->dropped;
+        return total;
+    }
+}
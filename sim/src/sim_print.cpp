@@ -0,0 +1,239 @@
+// String / Print / Stream / IPAddress 的主机实现
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <ctype.h>
+
+namespace
+{
+    std::string toBase(unsigned long long value, unsigned char base)
+    {
+        if (base < 2 || base > 36)
+            base = 10;
+        char buf[72];
+        char *p = buf + sizeof(buf) - 1;
+        *p = '\0';
+        do
+        {
+            int digit = value % base;
+            *--p = digit < 10 ? '0' + digit : 'a' + digit - 10;
+            value /= base;
+        } while (value);
+        return p;
+    }
+
+    std::string signedToBase(long long value, unsigned char base)
+    {
+        if (value < 0 && base == 10)
+            return "-" + toBase((unsigned long long)(-(value + 1)) + 1, base);
+        return toBase((unsigned long long)value, base);
+    }
+
+    std::string fromDouble(double value, unsigned int decimalPlaces)
+    {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, value);
+        return buf;
+    }
+}
+
+String::String(unsigned char value, unsigned char base) : _s(toBase(value, base)) {}
+String::String(int value, unsigned char base) : _s(signedToBase(value, base)) {}
+String::String(unsigned int value, unsigned char base) : _s(toBase(value, base)) {}
+String::String(long value, unsigned char base) : _s(signedToBase(value, base)) {}
+String::String(unsigned long value, unsigned char base) : _s(toBase(value, base)) {}
+String::String(long long value, unsigned char base) : _s(signedToBase(value, base)) {}
+String::String(unsigned long long value, unsigned char base) : _s(toBase(value, base)) {}
+String::String(float value, unsigned int decimalPlaces) : _s(fromDouble(value, decimalPlaces)) {}
+String::String(double value, unsigned int decimalPlaces) : _s(fromDouble(value, decimalPlaces)) {}
+
+bool String::equalsIgnoreCase(const String &s) const
+{
+    if (_s.size() != s._s.size())
+        return false;
+    for (size_t i = 0; i < _s.size(); i++)
+    {
+        if (tolower((unsigned char)_s[i]) != tolower((unsigned char)s._s[i]))
+            return false;
+    }
+    return true;
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const
+{
+    size_t pos = _s.find(ch, fromIndex);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String &str, unsigned int fromIndex) const
+{
+    size_t pos = _s.find(str._s, fromIndex);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(char ch) const
+{
+    size_t pos = _s.rfind(ch);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int beginIndex) const
+{
+    return beginIndex < _s.size() ? String(_s.substr(beginIndex)) : String();
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const
+{
+    if (beginIndex > endIndex)
+        std::swap(beginIndex, endIndex);
+    if (beginIndex >= _s.size())
+        return String();
+    return String(_s.substr(beginIndex, endIndex - beginIndex));
+}
+
+void String::replace(char find, char replace)
+{
+    std::replace(_s.begin(), _s.end(), find, replace);
+}
+
+void String::replace(const String &find, const String &replace)
+{
+    if (find._s.empty())
+        return;
+    size_t pos = 0;
+    while ((pos = _s.find(find._s, pos)) != std::string::npos)
+    {
+        _s.replace(pos, find._s.size(), replace._s);
+        pos += replace._s.size();
+    }
+}
+
+void String::remove(unsigned int index, unsigned int count)
+{
+    if (index < _s.size())
+        _s.erase(index, count);
+}
+
+void String::toLowerCase()
+{
+    for (auto &c : _s)
+        c = tolower((unsigned char)c);
+}
+
+void String::toUpperCase()
+{
+    for (auto &c : _s)
+        c = toupper((unsigned char)c);
+}
+
+void String::trim()
+{
+    size_t begin = _s.find_first_not_of(" \t\r\n");
+    size_t end = _s.find_last_not_of(" \t\r\n");
+    _s = begin == std::string::npos ? std::string() : _s.substr(begin, end - begin + 1);
+}
+
+long String::toInt() const { return atol(_s.c_str()); }
+float String::toFloat() const { return (float)atof(_s.c_str()); }
+double String::toDouble() const { return atof(_s.c_str()); }
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t n = 0;
+    while (size--)
+    {
+        if (!write(*buffer++))
+            break;
+        n++;
+    }
+    return n;
+}
+
+size_t Print::printf(const char *format, ...)
+{
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (len < 0)
+        return 0;
+    return write((const uint8_t *)buf, std::min((size_t)len, sizeof(buf) - 1));
+}
+
+size_t Print::print(const String &s) { return write(s.c_str(), s.length()); }
+size_t Print::print(const char str[]) { return write(str); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+size_t Print::print(unsigned char n, int base) { return print(String(n, (unsigned char)base)); }
+size_t Print::print(int n, int base) { return print(String(n, (unsigned char)base)); }
+size_t Print::print(unsigned int n, int base) { return print(String(n, (unsigned char)base)); }
+size_t Print::print(long n, int base) { return print(String(n, (unsigned char)base)); }
+size_t Print::print(unsigned long n, int base) { return print(String(n, (unsigned char)base)); }
+size_t Print::print(long long n, int base) { return print(String(n, (unsigned char)base)); }
+size_t Print::print(unsigned long long n, int base) { return print(String(n, (unsigned char)base)); }
+size_t Print::print(double n, int digits) { return print(String(n, (unsigned int)digits)); }
+size_t Print::print(const Printable &x) { return x.printTo(*this); }
+
+size_t Print::println(void) { return write("\r\n"); }
+size_t Print::println(const String &s) { return print(s) + println(); }
+size_t Print::println(const char str[]) { return print(str) + println(); }
+size_t Print::println(char c) { return print(c) + println(); }
+size_t Print::println(unsigned char n, int base) { return print(n, base) + println(); }
+size_t Print::println(int n, int base) { return print(n, base) + println(); }
+size_t Print::println(unsigned int n, int base) { return print(n, base) + println(); }
+size_t Print::println(long n, int base) { return print(n, base) + println(); }
+size_t Print::println(unsigned long n, int base) { return print(n, base) + println(); }
+size_t Print::println(long long n, int base) { return print(n, base) + println(); }
+size_t Print::println(unsigned long long n, int base) { return print(n, base) + println(); }
+size_t Print::println(double n, int digits) { return print(n, digits) + println(); }
+size_t Print::println(const Printable &x) { return print(x) + println(); }
+
+size_t Stream::readBytes(char *buffer, size_t length)
+{
+    size_t count = 0;
+    while (count < length)
+    {
+        int c = read();
+        if (c < 0)
+            break;
+        *buffer++ = (char)c;
+        count++;
+    }
+    return count;
+}
+
+String Stream::readString()
+{
+    String ret;
+    int c;
+    while ((c = read()) >= 0)
+        ret += (char)c;
+    return ret;
+}
+
+const IPAddress INADDR_NONE(0, 0, 0, 0);
+
+String IPAddress::toString() const
+{
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _addr[0], _addr[1], _addr[2], _addr[3]);
+    return String(buf);
+}
+
+bool IPAddress::fromString(const char *address)
+{
+    unsigned int a, b, c, d;
+    if (!address || sscanf(address, "%u.%u.%u.%u", &a, &b, &c, &d) != 4 || a > 255 || b > 255 || c > 255 || d > 255)
+        return false;
+    _addr[0] = a;
+    _addr[1] = b;
+    _addr[2] = c;
+    _addr[3] = d;
+    return true;
+}
+
+size_t IPAddress::printTo(Print &p) const
+{
+    return p.print(toString());
+}
@@ -0,0 +1,241 @@
+// MQTT 压测：脚本动作 storm 按设定的速率与比例生成命令，经进程内 broker 投递给设备，
+// 并根据设备在 MQTT_ACK_TOPIC 上的回执统计吞吐、丢失率与延迟分位数。
+//
+//   <时间ms> storm <时长ms> <每秒条数> <steady|burst:N> <有效/无效/超长 比例> <密码>
+//   1000 storm 5000 2000 steady 80/15/5 12345678
+//   1000 storm 5000 2000 burst:200 100/0/0 12345678   每 N 条一次性突发，平均速率不变
+//
+// 有效命令为带 seq 的 position；无效命令轮流为 JSON 截断、未知命令、密码错误和格式错误的 sequence；
+// 超长命令带填充字段，超过 PubSubClient 的缓冲区。负载由 SIM_STORM_SEED（默认 1）决定，结果可复现
+#include <sim.h>
+#include <config.h>
+#include <command_router.h>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+    enum StormKind
+    {
+        STORM_VALID,
+        STORM_INVALID,
+        STORM_OVERSIZED,
+        STORM_KIND_COUNT
+    };
+
+    const char *const KIND_NAMES[STORM_KIND_COUNT] = {"valid", "invalid", "oversized"};
+    const size_t OVERSIZED_PAD = 1024;
+
+    struct StormMessage
+    {
+        uint8_t kind;
+        bool acked;
+        unsigned long sentUs;
+    };
+
+    std::vector<StormMessage> messages; // 下标为 seq - 1
+    std::vector<unsigned long> roundTripUs;
+    std::vector<unsigned long> deviceLatencyUs;
+    std::string password;
+    unsigned long sent[STORM_KIND_COUNT];
+    unsigned long acked[STORM_KIND_COUNT];
+    unsigned long ackErrors = 0;  // 回执 result 为错误
+    unsigned long superseded = 0; // 执行前被后续 position 覆盖，不计入延迟
+    unsigned long duplicateAcks = 0;
+    unsigned long firstSentUs = 0;
+    unsigned long lastAckUs = 0;
+    size_t heapBaseline = 0;
+    uint32_t rng = 1;
+
+    uint32_t nextRandom()
+    {
+        rng = rng * 1103515245 + 12345;
+        return (rng >> 16) & 0x7FFF;
+    }
+
+    unsigned long percentile(std::vector<unsigned long> &values, double p)
+    {
+        if (values.empty())
+            return 0;
+        size_t index = std::min(values.size() - 1, (size_t)(values.size() * p));
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+
+    void printLatency(const char *label, std::vector<unsigned long> &values)
+    {
+        if (values.empty())
+            return;
+        unsigned long p50 = percentile(values, 0.50);
+        unsigned long p90 = percentile(values, 0.90);
+        unsigned long p99 = percentile(values, 0.99);
+        unsigned long max = *std::max_element(values.begin(), values.end());
+        fprintf(stderr, "[sim] %-18sp50 %lu / p90 %lu / p99 %lu / max %lu us\n", label, p50, p90, p99, max);
+    }
+}
+
+namespace sim
+{
+    bool stormPlan(unsigned long at, const std::string &args, std::vector<std::pair<unsigned long, std::string>> &events)
+    {
+        char pattern[32] = {};
+        char pwd[64] = {};
+        unsigned long duration, rate;
+        unsigned mix[STORM_KIND_COUNT];
+        if (sscanf(args.c_str(), "%lu %lu %31s %u/%u/%u %63s", &duration, &rate, pattern, &mix[0], &mix[1], &mix[2], pwd) != 7 || rate == 0)
+        {
+            fprintf(stderr, "[sim] bad storm arguments: %s\n", args.c_str());
+            return false;
+        }
+        unsigned burst = 1;
+        if (strncmp(pattern, "burst:", 6) == 0)
+            burst = std::max(1, atoi(pattern + 6));
+        unsigned total = mix[0] + mix[1] + mix[2];
+        if (total == 0)
+            return false;
+
+        static bool seeded = false;
+        if (!seeded)
+        {
+            const char *seed = getenv("SIM_STORM_SEED");
+            rng = seed ? strtoul(seed, nullptr, 10) : 1;
+            seeded = true;
+        }
+        password = pwd;
+
+        // 每条消息的发送时间按平均速率计算，突发模式把 N 条消息集中到这一组的第一条
+        unsigned long count = duration * rate / 1000;
+        messages.reserve(messages.size() + count);
+        for (unsigned long i = 0; i < count; i++)
+        {
+            unsigned long group = i - i % burst;
+            unsigned long time = at + group * 1000 / rate;
+            unsigned roll = nextRandom() % total;
+            uint8_t kind = roll < mix[0] ? STORM_VALID : roll < mix[0] + mix[1] ? STORM_INVALID : STORM_OVERSIZED;
+            messages.push_back({kind, false, 0});
+            events.push_back({time, std::to_string(messages.size())});
+        }
+        roundTripUs.reserve(messages.size());
+        deviceLatencyUs.reserve(messages.size());
+        return true;
+    }
+
+    // 负载写在栈上，发送过程本身不分配堆内存
+    void stormSend(const std::string &args)
+    {
+        unsigned long seq = strtoul(args.c_str(), nullptr, 10);
+        if (seq == 0 || seq > messages.size())
+            return;
+        StormMessage &message = messages[seq - 1];
+        char payload[OVERSIZED_PAD + 256];
+        int length = 0;
+        int position = (int)(seq * 37 % 181);
+        const char *pwd = password.c_str();
+        switch (message.kind)
+        {
+        case STORM_VALID:
+            length = snprintf(payload, sizeof(payload), "{\"command\":\"position\",\"position\":%d,\"channel\":0,\"seq\":%lu,\"pwd\":\"%s\"}", position, seq, pwd);
+            break;
+        case STORM_INVALID:
+            switch (seq % 4)
+            {
+            case 0:
+                length = snprintf(payload, sizeof(payload), "{\"command\":\"position\",\"position\":%d,\"se", position);
+                break;
+            case 1:
+                length = snprintf(payload, sizeof(payload), "{\"command\":\"jump\",\"seq\":%lu,\"pwd\":\"%s\"}", seq, pwd);
+                break;
+            case 2:
+                length = snprintf(payload, sizeof(payload), "{\"command\":\"position\",\"position\":%d,\"seq\":%lu,\"pwd\":\"wrong\"}", position, seq);
+                break;
+            default:
+                length = snprintf(payload, sizeof(payload), "{\"command\":\"sequence\",\"frames\":[[400,10]],\"seq\":%lu,\"pwd\":\"%s\"}", seq, pwd);
+                break;
+            }
+            break;
+        default:
+            length = snprintf(payload, sizeof(payload), "{\"command\":\"position\",\"position\":%d,\"seq\":%lu,\"pwd\":\"%s\",\"pad\":\"", position, seq, pwd);
+            memset(payload + length, 'x', OVERSIZED_PAD);
+            length += OVERSIZED_PAD;
+            length += snprintf(payload + length, sizeof(payload) - length, "\"}");
+            break;
+        }
+
+        unsigned long now = micros();
+        if (!firstSentUs)
+        {
+            firstSentUs = now;
+            heapBaseline = ESP.getHeapSize() - ESP.getFreeHeap();
+        }
+        message.sentUs = now;
+        sent[message.kind]++;
+        mqttPublish(MQTT_TOPIC, (const uint8_t *)payload, length);
+    }
+
+    // broker 收到设备的每条 PUBLISH 都交给这里，只处理 JSON 回执
+    void stormDevicePublish(const std::string &topic, const uint8_t *payload, size_t length)
+    {
+        if (messages.empty() || topic != MQTT_ACK_TOPIC)
+            return;
+        char text[96];
+        length = std::min(length, sizeof(text) - 1);
+        memcpy(text, payload, length);
+        text[length] = '\0';
+
+        unsigned long seq, latency = 0;
+        unsigned result;
+        if (sscanf(text, "{\"seq\":%lu,\"result\":%u", &seq, &result) != 2 || seq == 0 || seq > messages.size())
+            return;
+        StormMessage &message = messages[seq - 1];
+        if (message.acked || strstr(text, "\"dup\""))
+        {
+            duplicateAcks++;
+            return;
+        }
+        message.acked = true;
+        acked[message.kind]++;
+        if (result == COMMAND_SUPERSEDED)
+        {
+            superseded++;
+            return;
+        }
+        if (result != COMMAND_OK)
+        {
+            ackErrors++;
+            return;
+        }
+        unsigned long now = micros();
+        lastAckUs = now;
+        roundTripUs.push_back(now - message.sentUs);
+        const char *field = strstr(text, "\"latency_us\":");
+        if (field && sscanf(field, "\"latency_us\":%lu", &latency) == 1)
+            deviceLatencyUs.push_back(latency);
+    }
+
+    void stormReport()
+    {
+        if (messages.empty())
+            return;
+        unsigned long totalSent = sent[STORM_VALID] + sent[STORM_INVALID] + sent[STORM_OVERSIZED];
+        fprintf(stderr, "[sim] storm sent        %lu (", totalSent);
+        for (int kind = 0; kind < STORM_KIND_COUNT; kind++)
+            fprintf(stderr, "%s%s %lu", kind ? ", " : "", KIND_NAMES[kind], sent[kind]);
+        fprintf(stderr, ")\n");
+        fprintf(stderr, "[sim] storm acked       %lu valid (%lu superseded), %lu rejected, %lu duplicate acks\n",
+                acked[STORM_VALID], superseded, ackErrors, duplicateAcks);
+        if (sent[STORM_VALID])
+        {
+            unsigned long lost = sent[STORM_VALID] - acked[STORM_VALID];
+            fprintf(stderr, "[sim] storm drop rate   %.2f%% (%lu valid commands without ack)\n", 100.0 * lost / sent[STORM_VALID], lost);
+        }
+        if (lastAckUs > firstSentUs)
+            fprintf(stderr, "[sim] storm throughput  %.0f acked commands/s\n", acked[STORM_VALID] * 1e6 / (lastAckUs - firstSentUs));
+        printLatency("storm round trip", roundTripUs);
+        printLatency("storm device", deviceLatencyUs);
+        size_t peak = ESP.getHeapSize() - ESP.getMinFreeHeap();
+        fprintf(stderr, "[sim] storm heap        peak %zu bytes (%zu at storm start)\n", peak, heapBaseline);
+    }
+}
@@ -0,0 +1,150 @@
+// 模拟 WebSocketsServer：注入的连接和消息在 loop() 中按顺序回调
+#include <WebSocketsServer.h>
+#include <sim.h>
+#include <algorithm>
+
+namespace
+{
+    std::vector<WebSocketsServer *> &servers()
+    {
+        static std::vector<WebSocketsServer *> instances;
+        return instances;
+    }
+
+    WebSocketsServer *findServer(uint16_t port)
+    {
+        for (auto *server : servers())
+        {
+            if (server->port() == port)
+                return server;
+        }
+        return nullptr;
+    }
+
+    unsigned long sentMessages = 0;
+    unsigned long sentBytes = 0;
+
+    void enqueue(int num, WStype_t type, const uint8_t *data, size_t length, uint16_t port)
+    {
+        WebSocketsServer *server = findServer(port);
+        if (!server || num < 0)
+            return;
+        WebSocketsServer::Event event;
+        event.num = num;
+        event.type = type;
+        event.payload.assign(data, data + length);
+        server->enqueue(event);
+    }
+}
+
+namespace sim
+{
+    int wsOpen(uint16_t port)
+    {
+        WebSocketsServer *server = findServer(port);
+        if (!server)
+            return -1;
+        int num = server->allocateClient();
+        enqueue(num, WStype_CONNECTED, nullptr, 0, port);
+        return num;
+    }
+
+    void wsSend(int num, bool binary, const uint8_t *data, size_t length, uint16_t port)
+    {
+        enqueue(num, binary ? WStype_BIN : WStype_TEXT, data, length, port);
+    }
+
+    void wsClose(int num, uint16_t port)
+    {
+        enqueue(num, WStype_DISCONNECTED, nullptr, 0, port);
+    }
+
+    unsigned long wsSentCount() { return sentMessages; }
+    unsigned long wsSentBytes() { return sentBytes; }
+}
+
+WebSocketsServer::WebSocketsServer(uint16_t port, const String &origin, const String &protocol) : _port(port)
+{
+    servers().push_back(this);
+}
+
+WebSocketsServer::~WebSocketsServer()
+{
+    servers().erase(std::remove(servers().begin(), servers().end(), this), servers().end());
+}
+
+int WebSocketsServer::allocateClient()
+{
+    for (int i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++)
+    {
+        if (!_connected[i])
+        {
+            _connected[i] = true;
+            return i;
+        }
+    }
+    return -1;
+}
+
+void WebSocketsServer::loop()
+{
+    if (!_started)
+        return;
+    while (!_pending.empty())
+    {
+        Event event = _pending.front();
+        _pending.pop_front();
+        if (event.type == WStype_DISCONNECTED)
+            _connected[event.num] = false;
+        if (_cbEvent)
+            _cbEvent(event.num, event.type, event.payload.data(), event.payload.size());
+    }
+}
+
+bool WebSocketsServer::sendTXT(uint8_t num, const char *payload, size_t length, bool headerToPayload)
+{
+    if (num >= WEBSOCKETS_SERVER_CLIENT_MAX || !_connected[num])
+        return false;
+    if (length == 0)
+        length = strlen(payload);
+    sentMessages++;
+    sentBytes += length;
+    if (!sim::quiet())
+        printf("[ws %u] %.*s\n", num, (int)length, payload);
+    return true;
+}
+
+bool WebSocketsServer::broadcastTXT(const char *payload, size_t length, bool headerToPayload)
+{
+    bool sent = false;
+    for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++)
+    {
+        if (_connected[i])
+            sent = sendTXT(i, payload, length) || sent;
+    }
+    return sent;
+}
+
+bool WebSocketsServer::sendBIN(uint8_t num, const uint8_t *payload, size_t length, bool headerToPayload)
+{
+    if (num >= WEBSOCKETS_SERVER_CLIENT_MAX || !_connected[num])
+        return false;
+    sentMessages++;
+    sentBytes += length;
+    return true;
+}
+
+uint8_t WebSocketsServer::connectedClients(bool ping)
+{
+    return std::count(_connected, _connected + WEBSOCKETS_SERVER_CLIENT_MAX, true);
+}
+
+void WebSocketsServer::disconnect(uint8_t num)
+{
+    if (num < WEBSOCKETS_SERVER_CLIENT_MAX && _connected[num])
+    {
+        _connected[num] = false;
+        if (_cbEvent)
+            _cbEvent(num, WStype_DISCONNECTED, nullptr, 0);
+    }
+}
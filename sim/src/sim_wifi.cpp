@@ -0,0 +1,251 @@
+// 模拟 WiFi 站点/AP 与 WiFiClient
+#include <WiFi.h>
+#include <sim.h>
+
+WiFiClass WiFi;
+
+namespace
+{
+    bool linkUp = true;
+
+    unsigned long envMs(const char *name, unsigned long fallback)
+    {
+        const char *value = getenv(name);
+        return value ? strtoul(value, nullptr, 10) : fallback;
+    }
+
+    // 可见网络列表中的第 index 个 SSID
+    bool visibleNetwork(int index, String &ssid)
+    {
+        const char *list = getenv("SIM_WIFI_SSID");
+        if (!list)
+            return false;
+        for (int i = 0;; i++)
+        {
+            const char *comma = strchr(list, ',');
+            if (i == index)
+            {
+                ssid = comma ? String(list).substring(0, comma - list) : String(list);
+                return true;
+            }
+            if (!comma)
+                return false;
+            list = comma + 1;
+        }
+    }
+
+    bool ssidAvailable(const String &ssid)
+    {
+        if (!getenv("SIM_WIFI_SSID"))
+            return true;
+        String visible;
+        for (int i = 0; visibleNetwork(i, visible); i++)
+        {
+            if (visible == ssid)
+                return true;
+        }
+        return false;
+    }
+
+    // 每个 SSID 固定对应一个接入点
+    void accessPoint(const String &ssid, uint8_t *bssid, int32_t &channel)
+    {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < ssid.length(); i++)
+            hash = (hash ^ (uint8_t)ssid[i]) * 16777619u;
+        const uint8_t prefix[3] = {0x24, 0x0A, 0xC4};
+        memcpy(bssid, prefix, 3);
+        bssid[3] = hash >> 16;
+        bssid[4] = hash >> 8;
+        bssid[5] = hash;
+        channel = 1 + hash % 11;
+    }
+}
+
+namespace sim
+{
+    void setWiFiLink(bool up) { linkUp = up; }
+    bool wifiLinkUp() { return linkUp; }
+}
+
+bool WiFiClass::mode(wifi_mode_t m)
+{
+    _mode = m;
+    return true;
+}
+
+wl_status_t WiFiClass::begin(const char *ssid, const char *passphrase, int32_t channel,
+                             const uint8_t *bssid, bool connect)
+{
+    if (_mode == WIFI_OFF || _mode == WIFI_AP)
+        _mode = WIFI_STA;
+    _ssid = ssid;
+    _connected = false;
+    _connecting = connect;
+    accessPoint(_ssid, _bssid, _channel);
+
+    unsigned long scanMs = envMs("SIM_WIFI_SCAN_MS", 500);
+    unsigned long dhcpMs = envMs("SIM_WIFI_DHCP_MS", 150);
+    long delayMs = envMs("SIM_WIFI_CONNECT_MS", 800);
+    _targetValid = true;
+    if (channel > 0 && bssid)
+    {
+        _targetValid = channel == _channel && memcmp(bssid, _bssid, 6) == 0;
+        delayMs -= scanMs;
+    }
+    if (_staticIP)
+        delayMs -= dhcpMs;
+    _connectAt = millis() + (delayMs > 50 ? delayMs : 50);
+    return WL_DISCONNECTED;
+}
+
+wl_status_t WiFiClass::status()
+{
+    if (_connecting && (long)(millis() - _connectAt) >= 0)
+    {
+        _connecting = false;
+        _connected = linkUp && _targetValid && ssidAvailable(_ssid);
+        if (!_connected)
+            return WL_NO_SSID_AVAIL; // 链路断开时同样找不到接入点
+    }
+    if (_connected && !linkUp)
+    {
+        _connected = false;
+        return WL_CONNECTION_LOST;
+    }
+    return _connected ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+bool WiFiClass::disconnect(bool wifioff, bool eraseap)
+{
+    _connected = false;
+    _connecting = false;
+    if (wifioff)
+        _mode = WIFI_OFF;
+    return true;
+}
+
+bool WiFiClass::config(IPAddress local_ip, IPAddress gateway, IPAddress subnet, IPAddress dns1)
+{
+    _staticIP = local_ip;
+    return true;
+}
+
+IPAddress WiFiClass::localIP()
+{
+    if (status() != WL_CONNECTED)
+        return IPAddress();
+    return _staticIP ? IPAddress(_staticIP) : IPAddress(192, 168, 1, 50);
+}
+
+int16_t WiFiClass::scanNetworks(bool async)
+{
+    _scanCount = WIFI_SCAN_RUNNING;
+    _scanDoneAt = millis() + envMs("SIM_WIFI_SCAN_MS", 500);
+    if (!async)
+    {
+        delay(_scanDoneAt - millis());
+        return scanComplete();
+    }
+    return WIFI_SCAN_RUNNING;
+}
+
+int16_t WiFiClass::scanComplete()
+{
+    if (_scanCount == WIFI_SCAN_RUNNING && (long)(millis() - _scanDoneAt) >= 0)
+    {
+        String ssid;
+        int count = 0;
+        while (linkUp && visibleNetwork(count, ssid))
+            count++;
+        _scanCount = count;
+    }
+    return _scanCount;
+}
+
+String WiFiClass::SSID(uint8_t index)
+{
+    String ssid;
+    return visibleNetwork(index, ssid) ? ssid : String();
+}
+
+int32_t WiFiClass::RSSI(uint8_t index)
+{
+    return -50 - 5 * index;
+}
+
+uint8_t *WiFiClass::BSSID(uint8_t index)
+{
+    int32_t channel;
+    accessPoint(SSID(index), _scanBssid, channel);
+    return _scanBssid;
+}
+
+int32_t WiFiClass::channel(uint8_t index)
+{
+    uint8_t bssid[6];
+    int32_t channel;
+    accessPoint(SSID(index), bssid, channel);
+    return channel;
+}
+
+bool WiFiClass::softAP(const char *ssid, const char *passphrase, int channel,
+                       int ssid_hidden, int max_connection)
+{
+    _mode = _mode == WIFI_STA ? WIFI_AP_STA : WIFI_AP;
+    return true;
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port)
+{
+    return connect(ip.toString().c_str(), port);
+}
+
+int WiFiClient::connect(const char *host, uint16_t port)
+{
+    if (!WiFi.isConnected())
+        return 0;
+    _socket = sim::brokerConnect(host, port);
+    _outbound = true;
+    return _socket ? 1 : 0;
+}
+
+size_t WiFiClient::write(const uint8_t *buf, size_t size)
+{
+    return connected() ? _socket->send(buf, size) : 0;
+}
+
+int WiFiClient::available()
+{
+    return _socket ? _socket->available() : 0;
+}
+
+int WiFiClient::read()
+{
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+}
+
+int WiFiClient::read(uint8_t *buf, size_t size)
+{
+    return _socket ? _socket->read(buf, size) : -1;
+}
+
+int WiFiClient::peek()
+{
+    return _socket ? _socket->peek() : -1;
+}
+
+void WiFiClient::stop()
+{
+    if (_socket)
+        _socket->close();
+    _socket.reset();
+}
+
+uint8_t WiFiClient::connected()
+{
+    if (_socket && _outbound && !WiFi.isConnected())
+        _socket->close();
+    return _socket && (_socket->connected() || _socket->available());
+}
@@ -0,0 +1,271 @@
+// 模拟 WiFiServer：进程内注入的 HTTP 请求与本机 TCP 连接
+#include <WiFi.h>
+#include <sim.h>
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+    std::vector<WiFiServer *> &servers()
+    {
+        static std::vector<WiFiServer *> instances;
+        return instances;
+    }
+
+    // 进程内连接：两端共享的收发队列
+    struct Pipe
+    {
+        std::deque<uint8_t> toDevice;
+        std::string toClient;
+        bool deviceClosed = false;
+    };
+
+    class DeviceEnd : public sim::Socket
+    {
+    public:
+        explicit DeviceEnd(std::shared_ptr<Pipe> pipe) : _pipe(pipe) {}
+
+        size_t send(const uint8_t *data, size_t size) override
+        {
+            if (_pipe->deviceClosed)
+                return 0;
+            _pipe->toClient.append((const char *)data, size);
+            return size;
+        }
+        int available() override { return _pipe->toDevice.size(); }
+        int read(uint8_t *buf, size_t size) override
+        {
+            if (_pipe->toDevice.empty())
+                return -1;
+            size_t n = std::min(size, _pipe->toDevice.size());
+            std::copy(_pipe->toDevice.begin(), _pipe->toDevice.begin() + n, buf);
+            _pipe->toDevice.erase(_pipe->toDevice.begin(), _pipe->toDevice.begin() + n);
+            return n;
+        }
+        int peek() override { return _pipe->toDevice.empty() ? -1 : _pipe->toDevice.front(); }
+        bool connected() override { return !_pipe->deviceClosed; }
+        void close() override;
+
+    private:
+        std::shared_ptr<Pipe> _pipe;
+    };
+
+    std::shared_ptr<Pipe> lastPipe;
+    int lastStatus = 0;
+    String lastBody;
+
+    void parseResponse(const std::string &response)
+    {
+        lastStatus = 0;
+        if (response.compare(0, 9, "HTTP/1.1 ") == 0)
+            lastStatus = atoi(response.c_str() + 9);
+        size_t bodyStart = response.find("\r\n\r\n");
+        lastBody = bodyStart == std::string::npos ? "" : response.substr(bodyStart + 4).c_str();
+    }
+
+    void DeviceEnd::close()
+    {
+        if (_pipe->deviceClosed)
+            return;
+        _pipe->deviceClosed = true;
+        if (_pipe == lastPipe)
+        {
+            parseResponse(_pipe->toClient);
+            if (!sim::quiet())
+                printf("[sim] HTTP %d (%u bytes)\n", lastStatus, lastBody.length());
+        }
+    }
+
+    // 本机 TCP 连接，非阻塞读；写满时等待，与 lwip 发送缓冲满时的行为一致
+    class TcpSocket : public sim::Socket
+    {
+    public:
+        explicit TcpSocket(int fd) : _fd(fd) {}
+        ~TcpSocket() { close(); }
+
+        size_t send(const uint8_t *data, size_t size) override
+        {
+            size_t sent = 0;
+            while (_fd >= 0 && sent < size)
+            {
+                ssize_t n = ::send(_fd, data + sent, size - sent, MSG_NOSIGNAL);
+                if (n > 0)
+                {
+                    sent += n;
+                    continue;
+                }
+                if (n < 0 && errno == EAGAIN)
+                {
+                    pollfd pfd = {_fd, POLLOUT, 0};
+                    ::poll(&pfd, 1, 100);
+                    continue;
+                }
+                _peerClosed = true;
+                break;
+            }
+            return sent;
+        }
+        int available() override
+        {
+            fill();
+            return _rx.size();
+        }
+        int read(uint8_t *buf, size_t size) override
+        {
+            fill();
+            if (_rx.empty())
+                return -1;
+            size_t n = std::min(size, _rx.size());
+            std::copy(_rx.begin(), _rx.begin() + n, buf);
+            _rx.erase(_rx.begin(), _rx.begin() + n);
+            return n;
+        }
+        int peek() override
+        {
+            fill();
+            return _rx.empty() ? -1 : _rx.front();
+        }
+        bool connected() override
+        {
+            fill();
+            return _fd >= 0 && !_peerClosed;
+        }
+        void close() override
+        {
+            if (_fd >= 0)
+                ::close(_fd);
+            _fd = -1;
+        }
+
+    private:
+        void fill()
+        {
+            uint8_t buf[4096];
+            while (_fd >= 0 && !_peerClosed)
+            {
+                ssize_t n = ::recv(_fd, buf, sizeof(buf), 0);
+                if (n > 0)
+                    _rx.insert(_rx.end(), buf, buf + n);
+                else if (n == 0 || errno != EAGAIN)
+                    _peerClosed = true;
+                else
+                    break;
+            }
+        }
+
+        int _fd;
+        bool _peerClosed = false;
+        std::deque<uint8_t> _rx;
+    };
+
+    int listenTcp(uint16_t port)
+    {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 64) < 0)
+        {
+            fprintf(stderr, "[sim] cannot listen on 127.0.0.1:%u: %s\n", port, strerror(errno));
+            ::close(fd);
+            return -1;
+        }
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        fprintf(stderr, "[sim] HTTP listening on 127.0.0.1:%u\n", port);
+        return fd;
+    }
+}
+
+namespace sim
+{
+    void httpRequest(const char *method, const char *uri, const char *body, int port)
+    {
+        for (auto *server : servers())
+        {
+            if (server->port() != port)
+                continue;
+            size_t bodyLength = body ? strlen(body) : 0;
+            std::string request = std::string(method) + " " + uri + " HTTP/1.1\r\n" +
+                                  "Host: sim\r\nConnection: close\r\n";
+            if (bodyLength)
+                request += "Content-Type: application/json\r\nContent-Length: " + std::to_string(bodyLength) + "\r\n";
+            request += "\r\n";
+            if (bodyLength)
+                request += body;
+
+            lastPipe = std::make_shared<Pipe>();
+            lastPipe->toDevice.assign(request.begin(), request.end());
+            server->enqueue(std::make_shared<DeviceEnd>(lastPipe));
+            return;
+        }
+    }
+
+    int lastHttpStatus() { return lastStatus; }
+    const String &lastHttpBody() { return lastBody; }
+}
+
+WiFiServer::WiFiServer(uint16_t port, uint8_t maxClients) : _port(port)
+{
+    servers().push_back(this);
+}
+
+WiFiServer::~WiFiServer()
+{
+    end();
+    servers().erase(std::remove(servers().begin(), servers().end(), this), servers().end());
+}
+
+void WiFiServer::begin(uint16_t port)
+{
+    if (port)
+        _port = port;
+    _started = true;
+    const char *tcpPort = getenv("SIM_HTTP_PORT");
+    if (_port == 80 && tcpPort && _listenFd < 0)
+        _listenFd = listenTcp(atoi(tcpPort));
+}
+
+void WiFiServer::end()
+{
+    if (_listenFd >= 0)
+        ::close(_listenFd);
+    _listenFd = -1;
+    _started = false;
+}
+
+WiFiClient WiFiServer::accept()
+{
+    if (!_started)
+        return WiFiClient();
+    if (!_pending.empty())
+    {
+        WiFiClient client(_pending.front());
+        _pending.pop_front();
+        return client;
+    }
+    if (_listenFd >= 0)
+    {
+        int fd = ::accept(_listenFd, nullptr, nullptr);
+        if (fd >= 0)
+        {
+            int one = 1;
+            fcntl(fd, F_SETFL, O_NONBLOCK);
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            return WiFiClient(std::make_shared<TcpSocket>(fd));
+        }
+    }
+    return WiFiClient();
+}
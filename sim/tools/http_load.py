@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+# HTTP 压测：对模拟环境（SIM_HTTP_PORT）或真机发起并发请求，统计吞吐与延迟分位数
+#
+#   SIM_QUIET=1 SIM_HTTP_PORT=8080 .pio/build/native/program &
+#   python sim/tools/http_load.py --port 8080 --connections 4 --pipeline 4
+#   python sim/tools/http_load.py --port 8080 --connections 1 --close   # 每请求一个连接，对照旧的同步服务器
+import argparse
+import asyncio
+import time
+
+
+async def read_response(reader):
+    head = await reader.readuntil(b"\r\n\r\n")
+    status = int(head.split(b" ", 2)[1])
+    length = 0
+    for line in head.split(b"\r\n"):
+        if line.lower().startswith(b"content-length:"):
+            length = int(line.split(b":", 1)[1])
+    if length:
+        await reader.readexactly(length)
+    return status
+
+
+def build_request(args):
+    body = args.body.encode() if args.body else b""
+    lines = ["%s %s HTTP/1.1" % (args.method, args.path), "Host: %s" % args.host]
+    lines.append("Connection: %s" % ("close" if args.close else "keep-alive"))
+    if body:
+        lines += ["Content-Type: application/json", "Content-Length: %d" % len(body)]
+    return ("\r\n".join(lines) + "\r\n\r\n").encode() + body
+
+
+async def worker(args, request, count, latencies, errors):
+    reader = writer = None
+    done = 0
+    while done < count:
+        try:
+            if writer is None:
+                reader, writer = await asyncio.open_connection(args.host, args.port)
+            batch = 1 if args.close else min(args.pipeline, count - done)
+            start = time.perf_counter()
+            writer.write(request * batch)
+            await writer.drain()
+            for _ in range(batch):
+                status = await read_response(reader)
+                latencies.append(time.perf_counter() - start)
+                if status >= 400:
+                    errors[0] += 1
+            done += batch
+            if args.close:
+                writer.close()
+                writer = None
+        except (ConnectionError, asyncio.IncompleteReadError):
+            errors[0] += 1
+            done += 1
+            writer = None
+    if writer is not None:
+        writer.close()
+
+
+def percentile(values, p):
+    if not values:
+        return 0.0
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * p))]
+
+
+async def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--path", default="/status")
+    parser.add_argument("--method", default="GET")
+    parser.add_argument("--body", default="")
+    parser.add_argument("--requests", type=int, default=2000)
+    parser.add_argument("--connections", type=int, default=4)
+    parser.add_argument("--pipeline", type=int, default=1, help="每个连接同时发出的请求数")
+    parser.add_argument("--close", action="store_true", help="每个请求使用新连接")
+    args = parser.parse_args()
+
+    request = build_request(args)
+    latencies = []
+    errors = [0]
+    per_worker = args.requests // args.connections
+    start = time.perf_counter()
+    await asyncio.gather(*(worker(args, request, per_worker, latencies, errors) for _ in range(args.connections)))
+    elapsed = time.perf_counter() - start
+
+    print("requests     %d (%d errors)" % (len(latencies), errors[0]))
+    print("elapsed      %.2f s" % elapsed)
+    print("requests/s   %.0f" % (len(latencies) / elapsed))
+    print("latency p50  %.2f ms" % (percentile(latencies, 0.50) * 1000))
+    print("latency p99  %.2f ms" % (percentile(latencies, 0.99) * 1000))
+    print("latency max  %.2f ms" % (max(latencies or [0]) * 1000))
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
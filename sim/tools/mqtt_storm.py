@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+# MQTT 速率扫描：按递增的速率多次运行模拟程序的 storm 脚本，找出设备开始丢命令或延迟失控的速率
+#
+#   pio run -e native
+#   python sim/tools/mqtt_storm.py --rates 250,500,1000,2000,4000 --mix 80/15/5
+#   python sim/tools/mqtt_storm.py --pattern burst:200 --seed 7
+#
+# 需要已保存 WiFi 凭证的模拟闪存（见 sim/scripts/mqtt_burst.txt）；同一 --seed 的结果可复现
+import argparse
+import os
+import re
+import subprocess
+import tempfile
+
+FIELDS = {
+    "sent": re.compile(r"\[sim\] storm sent\s+(\d+)"),
+    "acked": re.compile(r"\[sim\] storm acked\s+(\d+) valid"),
+    "drop": re.compile(r"\[sim\] storm drop rate\s+([\d.]+)%"),
+    "throughput": re.compile(r"\[sim\] storm throughput\s+(\d+)"),
+    "rtt": re.compile(r"\[sim\] storm round trip\s+p50 (\d+) / p90 (\d+) / p99 (\d+) / max (\d+)"),
+    "heap": re.compile(r"\[sim\] storm heap\s+peak (\d+)"),
+    "dropped": re.compile(r"\[sim\] mqtt dropped\s+(\d+)"),
+}
+
+
+def run(args, rate):
+    script = "%d storm %d %d %s %s %s\n%d quit\n" % (
+        args.start, args.duration, rate, args.pattern, args.mix, args.password, args.start + args.duration + args.drain)
+    with tempfile.NamedTemporaryFile("w", suffix=".txt", delete=False) as f:
+        f.write(script)
+    env = dict(os.environ, SIM_QUIET="1", SIM_STORM_SEED=str(args.seed))
+    try:
+        result = subprocess.run([args.program, f.name], env=env, stderr=subprocess.PIPE, stdout=subprocess.DEVNULL, text=True)
+    finally:
+        os.unlink(f.name)
+    values = {}
+    for name, pattern in FIELDS.items():
+        match = pattern.search(result.stderr)
+        values[name] = match.groups() if match else None
+    return values
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--program", default=".pio/build/native/program")
+    parser.add_argument("--rates", default="250,500,1000,2000,4000,8000", help="逗号分隔的每秒命令数")
+    parser.add_argument("--pattern", default="steady", help="steady 或 burst:N")
+    parser.add_argument("--mix", default="100/0/0", help="有效/无效/超长 比例")
+    parser.add_argument("--password", default="12345678")
+    parser.add_argument("--duration", type=int, default=5000, help="每轮压测时长 ms")
+    parser.add_argument("--start", type=int, default=2000, help="等待 WiFi/MQTT 连接的时间 ms")
+    parser.add_argument("--drain", type=int, default=2000, help="压测结束后等待回执的时间 ms")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--max-drop", type=float, default=1.0, help="判定失败的丢失率 %%")
+    parser.add_argument("--max-p99", type=int, default=100000, help="判定失败的 p99 往返延迟 us")
+    args = parser.parse_args()
+
+    print("%8s %8s %8s %8s %10s %10s %10s %10s %10s" % (
+        "rate/s", "sent", "acked", "drop%", "acked/s", "p50 us", "p99 us", "max us", "heap"))
+    limit = None
+    for rate in [int(r) for r in args.rates.split(",")]:
+        v = run(args, rate)
+        if not v["sent"]:
+            print("%8d  no storm report (is the device connected?)" % rate)
+            continue
+        drop = float(v["drop"][0]) if v["drop"] else 0.0
+        rtt = [int(x) for x in v["rtt"]] if v["rtt"] else [0, 0, 0, 0]
+        print("%8d %8s %8s %8.2f %10s %10d %10d %10d %10s" % (
+            rate, v["sent"][0], v["acked"][0] if v["acked"] else "-", drop,
+            v["throughput"][0] if v["throughput"] else "-", rtt[0], rtt[2], rtt[3], v["heap"][0] if v["heap"] else "-"))
+        if limit is None and (drop > args.max_drop or rtt[2] > args.max_p99):
+            limit = rate
+    if limit is not None:
+        print("first failing rate: %d/s (drop > %.1f%% or p99 > %d us)" % (limit, args.max_drop, args.max_p99))
+    else:
+        print("no failing rate in range")
+
+
+if __name__ == "__main__":
+    main()
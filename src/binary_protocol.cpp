@@ -0,0 +1,136 @@
+#include "binary_protocol.h"
+
+static inline uint64_t rotl(uint64_t x, int b)
+{
+    return (x << b) | (x >> (64 - b));
+}
+
+static inline uint64_t readLE64(const uint8_t *p)
+{
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--)
+    {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+#define SIPROUND           \
+    do                     \
+    {                      \
+        v0 += v1;          \
+        v1 = rotl(v1, 13); \
+        v1 ^= v0;          \
+        v0 = rotl(v0, 32); \
+        v2 += v3;          \
+        v3 = rotl(v3, 16); \
+        v3 ^= v2;          \
+        v0 += v3;          \
+        v3 = rotl(v3, 21); \
+        v3 ^= v0;          \
+        v2 += v1;          \
+        v1 = rotl(v1, 17); \
+        v1 ^= v2;          \
+        v2 = rotl(v2, 32); \
+    } while (0)
+
+// SipHash-2-4，消息固定为 8 字节，只需处理一个分组和结尾长度块
+static uint64_t siphash24(const uint8_t key[16], const uint8_t message[8])
+{
+    uint64_t k0 = readLE64(key);
+    uint64_t k1 = readLE64(key + 8);
+    uint64_t v0 = 0x736f6d6570736575ULL ^ k0;
+    uint64_t v1 = 0x646f72616e646f6dULL ^ k1;
+    uint64_t v2 = 0x6c7967656e657261ULL ^ k0;
+    uint64_t v3 = 0x7465646279746573ULL ^ k1;
+
+    uint64_t m = readLE64(message);
+    v3 ^= m;
+    SIPROUND;
+    SIPROUND;
+    v0 ^= m;
+
+    uint64_t b = (uint64_t)8 << 56;
+    v3 ^= b;
+    SIPROUND;
+    SIPROUND;
+    v0 ^= b;
+
+    v2 ^= 0xff;
+    SIPROUND;
+    SIPROUND;
+    SIPROUND;
+    SIPROUND;
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+// 把任意长度的密码折叠成 16 字节密钥
+static void deriveKey(const char *password, uint8_t key[16])
+{
+    memset(key, 0, 16);
+    size_t length = password ? strlen(password) : 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        key[i % 16] ^= (uint8_t)password[i];
+        key[(i + 7) % 16] += (uint8_t)(password[i] * 31 + i);
+    }
+    key[15] ^= (uint8_t)length;
+}
+
+static uint32_t frameTag(const uint8_t *header, const char *password)
+{
+    uint8_t key[16];
+    deriveKey(password, key);
+    return (uint32_t)siphash24(key, header);
+}
+
+BinaryDecodeResult decodeBinaryFrame(const uint8_t *data, size_t length, const char *password, BinaryFrame &frame)
+{
+    if (length != BINARY_FRAME_SIZE)
+    {
+        return BIN_BAD_LENGTH;
+    }
+
+    uint32_t tag = data[8] | (data[9] << 8) | ((uint32_t)data[10] << 16) | ((uint32_t)data[11] << 24);
+    if (tag != frameTag(data, password))
+    {
+        return BIN_BAD_TAG;
+    }
+
+    frame.opcode = data[0];
+    frame.channel = data[1];
+    frame.position = data[2] | (data[3] << 8);
+    frame.flags = data[4];
+    frame.sequence = data[6] | (data[7] << 8);
+    return BIN_OK;
+}
+
+void encodeBinaryFrame(const BinaryFrame &frame, const char *password, uint8_t *out)
+{
+    out[0] = frame.opcode;
+    out[1] = frame.channel;
+    out[2] = frame.position & 0xFF;
+    out[3] = frame.position >> 8;
+    out[4] = frame.flags;
+    out[5] = 0;
+    out[6] = frame.sequence & 0xFF;
+    out[7] = frame.sequence >> 8;
+
+    uint32_t tag = frameTag(out, password);
+    out[8] = tag & 0xFF;
+    out[9] = (tag >> 8) & 0xFF;
+    out[10] = (tag >> 16) & 0xFF;
+    out[11] = tag >> 24;
+}
+
+void encodeBinaryAck(uint16_t sequence, uint8_t result, uint8_t flags, uint32_t latencyUs, uint8_t *out)
+{
+    out[0] = sequence & 0xFF;
+    out[1] = sequence >> 8;
+    out[2] = result;
+    out[3] = flags;
+    out[4] = latencyUs & 0xFF;
+    out[5] = (latencyUs >> 8) & 0xFF;
+    out[6] = (latencyUs >> 16) & 0xFF;
+    out[7] = latencyUs >> 24;
+}
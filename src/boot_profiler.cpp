@@ -0,0 +1,63 @@
+#include "boot_profiler.h"
+#include <esp_system.h>
+
+BootProfiler bootProfiler;
+
+static const char *const BOOT_STAGE_NAMES[BOOT_STAGE_COUNT] = {
+    "config",
+    "servo",
+    "led",
+    "wifi_started",
+    "network_init",
+    "setup_done",
+    "wifi_connected",
+    "mqtt_connected",
+    "first_command",
+};
+
+const char *BootProfiler::stageName(BootStage stage)
+{
+    return stage < BOOT_STAGE_COUNT ? BOOT_STAGE_NAMES[stage] : "";
+}
+
+void BootProfiler::mark(BootStage stage)
+{
+    if (stage >= BOOT_STAGE_COUNT || reached(stage))
+    {
+        return;
+    }
+    // micros() 从应用启动开始计时，不含引导程序的时间
+    _timeUs[stage] = micros();
+    _reached |= 1UL << stage;
+
+    Serial.print("[boot] ");
+    Serial.print(BOOT_STAGE_NAMES[stage]);
+    Serial.print(" ");
+    Serial.print(_timeUs[stage] / 1000.0f, 1);
+    Serial.println(" ms");
+}
+
+const char *BootProfiler::getResetReason() const
+{
+    switch (esp_reset_reason())
+    {
+    case ESP_RST_POWERON:
+        return "poweron";
+    case ESP_RST_BROWNOUT:
+        return "brownout";
+    case ESP_RST_SW:
+        return "software";
+    case ESP_RST_PANIC:
+        return "panic";
+    case ESP_RST_INT_WDT:
+    case ESP_RST_TASK_WDT:
+    case ESP_RST_WDT:
+        return "watchdog";
+    case ESP_RST_DEEPSLEEP:
+        return "deepsleep";
+    case ESP_RST_EXT:
+        return "external";
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,281 @@
+#include "command_router.h"
+#include "servo_control.h"
+#include "servo_task.h"
+#include "led_control.h"
+#include "boot_profiler.h"
+#include "trace.h"
+
+CommandRouter commandRouter;
+
+typedef CommandResult (*CommandHandler)(const Command &command, ServoCommand &servo);
+
+struct CommandEntry
+{
+    const char *name;
+    CommandType type;
+    CommandHandler handler;
+};
+
+// 命令名的完美哈希：长度与首尾字符之和取低位。对当前命令集无冲突，
+// 新增命令若发生冲突，调整 COMMAND_TABLE_SIZE 或哈希函数，static_assert 会在编译期报错
+static const int COMMAND_TABLE_SIZE = 8;
+
+static constexpr size_t constLength(const char *s)
+{
+    return *s ? 1 + constLength(s + 1) : 0;
+}
+
+static constexpr int commandHash(const char *name, size_t length)
+{
+    return (int)((length + (uint8_t)name[0] + (uint8_t)name[length - 1]) & (COMMAND_TABLE_SIZE - 1));
+}
+
+static CommandResult handleStart(const Command &command, ServoCommand &servo)
+{
+    (void)command;
+    servo.op = SERVO_OP_START;
+    if (!servoTask.submit(servo))
+    {
+        return COMMAND_REJECTED;
+    }
+    ledController.changeStatus(STATUS_SERVO_RUNNING);
+    return COMMAND_OK;
+}
+
+// 停止后短暂提示，之后 LED 回到网络状态
+static CommandResult handleStop(const Command &command, ServoCommand &servo)
+{
+    (void)command;
+    servo.op = SERVO_OP_STOP;
+    if (!servoTask.submit(servo))
+    {
+        return COMMAND_REJECTED;
+    }
+    ledController.clearLayer(LED_LAYER_SERVO);
+    ledController.changeStatus(STATUS_SERVO_STOPPED);
+    return COMMAND_OK;
+}
+
+static CommandResult handlePosition(const Command &command, ServoCommand &servo)
+{
+    servo.op = command.restore ? SERVO_OP_MOVE_RESTORE : SERVO_OP_MOVE;
+    if (!servoTask.submit(servo))
+    {
+        return COMMAND_REJECTED;
+    }
+    ledController.changeStatus(STATUS_MQTT_RECEIVE);
+    return COMMAND_OK;
+}
+
+static CommandResult handleSequence(const Command &command, ServoCommand &servo)
+{
+    servo.op = SERVO_OP_SEQUENCE;
+    servo.loops = command.loops;
+    servo.frameCount = command.frameCount;
+    memcpy(servo.frames, command.frames, command.frameCount * sizeof(SequenceKeyframe));
+    if (!servoTask.submit(servo))
+    {
+        return COMMAND_REJECTED;
+    }
+    ledController.changeStatus(STATUS_MQTT_RECEIVE);
+    return COMMAND_OK;
+}
+
+// 下标即命令名的哈希值，空位为 nullptr
+static constexpr CommandEntry COMMAND_TABLE[COMMAND_TABLE_SIZE] = {
+    {"sequence", CMD_SEQUENCE, handleSequence}, // 0
+    {nullptr, CMD_UNKNOWN, nullptr},
+    {nullptr, CMD_UNKNOWN, nullptr},
+    {nullptr, CMD_UNKNOWN, nullptr},
+    {"start", CMD_START, handleStart}, // 4
+    {nullptr, CMD_UNKNOWN, nullptr},
+    {"position", CMD_POSITION, handlePosition}, // 6
+    {"stop", CMD_STOP, handleStop},             // 7
+};
+
+static constexpr bool tableSlotsValid(int slot)
+{
+    return slot >= COMMAND_TABLE_SIZE ||
+           ((COMMAND_TABLE[slot].name == nullptr ||
+             commandHash(COMMAND_TABLE[slot].name, constLength(COMMAND_TABLE[slot].name)) == slot) &&
+            tableSlotsValid(slot + 1));
+}
+
+static_assert((COMMAND_TABLE_SIZE & (COMMAND_TABLE_SIZE - 1)) == 0, "COMMAND_TABLE_SIZE 必须是 2 的幂");
+static_assert(tableSlotsValid(0), "COMMAND_TABLE 中的命令必须位于其哈希值对应的下标");
+
+// CommandType 到分发表下标的反向索引，在编译期生成；-1 表示没有对应的命令。
+// 二进制帧与 WebSocket 直接给出 CommandType，分发时同样常数时间定位，不必扫描分发表
+static constexpr int slotOf(CommandType type, int slot = 0)
+{
+    return slot >= COMMAND_TABLE_SIZE ? -1
+           : COMMAND_TABLE[slot].name && COMMAND_TABLE[slot].type == type ? slot
+                                                                           : slotOf(type, slot + 1);
+}
+
+static constexpr int8_t COMMAND_SLOTS[] = {
+    slotOf(CMD_NONE),
+    slotOf(CMD_START),
+    slotOf(CMD_STOP),
+    slotOf(CMD_POSITION),
+    slotOf(CMD_SEQUENCE),
+    slotOf(CMD_UNKNOWN),
+};
+
+static_assert(sizeof(COMMAND_SLOTS) == CMD_UNKNOWN + 1, "COMMAND_SLOTS 必须覆盖所有 CommandType");
+
+static const CommandEntry *findEntry(CommandType type)
+{
+    if ((unsigned)type > CMD_UNKNOWN || COMMAND_SLOTS[type] < 0)
+    {
+        return nullptr;
+    }
+    return &COMMAND_TABLE[COMMAND_SLOTS[type]];
+}
+
+CommandType CommandRouter::lookup(const char *name)
+{
+    if (!name)
+    {
+        return CMD_NONE;
+    }
+    size_t length = strlen(name);
+    if (length == 0)
+    {
+        return CMD_UNKNOWN;
+    }
+    const CommandEntry &entry = COMMAND_TABLE[commandHash(name, length)];
+    return entry.name && strcmp(entry.name, name) == 0 ? entry.type : CMD_UNKNOWN;
+}
+
+const char *CommandRouter::name(CommandType type)
+{
+    const CommandEntry *entry = findEntry(type);
+    return entry ? entry->name : "";
+}
+
+int parseSequenceFrames(JsonArrayConst frames, SequenceKeyframe *out, int capacity)
+{
+    if (frames.isNull() || (int)frames.size() > capacity)
+    {
+        return -1;
+    }
+    int count = 0;
+    for (JsonVariantConst frame : frames)
+    {
+        float position;
+        long duration;
+        int easing;
+        if (frame.is<JsonArrayConst>())
+        {
+            position = frame[0] | -1.0f;
+            duration = frame[1] | -1L;
+            easing = frame[2] | (int)EASE_LINEAR;
+        }
+        else
+        {
+            position = frame["position"] | -1.0f;
+            duration = frame["duration"] | -1L;
+            easing = frame["easing"] | (int)EASE_LINEAR;
+        }
+        if (!isfinite(position) || position < 0 || position > 180 || duration < 0 || duration > 0xFFFF || easing < 0 || easing >= EASE_COUNT)
+        {
+            return -1;
+        }
+        out[count].position = (int16_t)lroundf(position * 100);
+        out[count].durationMs = (uint16_t)duration;
+        out[count].easing = (uint8_t)easing;
+        count++;
+    }
+    return count;
+}
+
+CommandResult CommandRouter::parse(JsonVariantConst doc, Command &command) const
+{
+    command.type = lookup(doc["command"]);
+    // 接受小数角度。非有限值按 0 处理，先限幅到 0~180 度再换算，浮点转整数不会溢出
+    float position = doc["position"] | 0.0f;
+    if (!isfinite(position))
+    {
+        position = 0;
+    }
+    command.position = (int)lroundf(constrain(position, 0.0f, 180.0f) * 100);
+    command.restore = (doc["restore"] | 0) == 1;
+    command.channel = doc["channel"] | -1;
+    command.group = doc["group"] | -1;
+    int loops = doc["loops"] | 1;
+    command.loops = (uint16_t)constrain(loops, 0, 0xFFFF);
+    command.frameCount = 0;
+    command.ack.route = 0;
+
+    if (command.type == CMD_NONE)
+    {
+        return COMMAND_MISSING;
+    }
+    if (command.type == CMD_UNKNOWN)
+    {
+        return COMMAND_UNKNOWN;
+    }
+    if (command.type == CMD_SEQUENCE)
+    {
+        int count = parseSequenceFrames(doc["frames"], command.frames, SERVO_SEQUENCE_CAPACITY);
+        if (count <= 0)
+        {
+            return COMMAND_INVALID;
+        }
+        command.frameCount = (uint8_t)count;
+    }
+    return COMMAND_OK;
+}
+
+CommandResult CommandRouter::dispatch(const Command &command)
+{
+    const CommandEntry *entry = findEntry(command.type);
+    if (!entry)
+    {
+        return command.type == CMD_NONE ? COMMAND_MISSING : COMMAND_UNKNOWN;
+    }
+
+    ServoCommand servo;
+    servo.channels = servoController.resolveChannels(command.channel, command.group);
+    if (servo.channels == 0)
+    {
+        return COMMAND_BAD_CHANNEL;
+    }
+    servo.position = constrain(command.position, 0, 18000);
+    servo.loops = 0;
+    servo.frameCount = 0;
+    servo.ack = command.ack;
+#if ENABLE_TRACE
+    servo.traceId = tracer.currentId();
+#endif
+    TRACE_STAGE(TRACE_DISPATCH);
+    CommandResult result = entry->handler(command, servo);
+    if (result == COMMAND_OK)
+    {
+        bootProfiler.mark(BOOT_FIRST_COMMAND);
+    }
+    return result;
+}
+
+const char *CommandRouter::resultMessage(CommandResult result)
+{
+    switch (result)
+    {
+    case COMMAND_OK:
+        return "控制命令已接收";
+    case COMMAND_MISSING:
+        return "缺少command字段";
+    case COMMAND_UNKNOWN:
+        return "未知命令";
+    case COMMAND_INVALID:
+        return "序列格式错误";
+    case COMMAND_REJECTED:
+        return "序列无效或命令队列已满";
+    case COMMAND_SUPERSEDED:
+        return "已被更新的目标覆盖";
+    case COMMAND_BAD_CHANNEL:
+        return "通道或分组不存在";
+    }
+    return "";
+}
@@ -0,0 +1,401 @@
+#include "config_store.h"
+#include <EEPROM.h>
+#include <stddef.h>
+
+ConfigStore configStore;
+
+static const uint32_t CONFIG_PAGE_MAGIC = 0x47464353; // "SCFG"
+static const uint16_t CONFIG_FORMAT_VERSION = 1;
+static const uint8_t CONFIG_RECORD_COMMIT = 0x01;
+static const uint8_t CONFIG_KEY_FREE = 0xFF; // 擦除后的闪存读出 0xFF
+
+struct ConfigPageHeader
+{
+    uint32_t magic;
+    uint32_t sequence;
+    uint16_t format;
+    uint16_t reserved;
+    uint32_t crc; // 覆盖前面的字段
+};
+
+struct ConfigRecordHeader
+{
+    uint8_t key;
+    uint8_t version;
+    uint8_t flags;
+    uint8_t reserved;
+    uint16_t length;
+    uint16_t reserved2;
+    uint32_t crc; // 覆盖前面的字段与负载
+};
+
+struct ConfigKeyInfo
+{
+    size_t offset;
+    size_t size;
+    uint8_t version;
+};
+
+// 结构只允许在末尾追加字段并把版本加一：旧版本记录按前缀读取，新增字段保留默认值，
+// 下一次提交时按新版本重写
+static const ConfigKeyInfo CONFIG_KEYS[CONFIG_KEY_COUNT] = {
+    {offsetof(ConfigData, networks), sizeof(WiFiCredentials) * WIFI_MAX_NETWORKS, 2}, // 版本 1 只有一个网络
+    {offsetof(ConfigData, mqtt), sizeof(MqttSettings), 1},
+    {offsetof(ConfigData, calibration), sizeof(ServoCalibration) * SERVO_MAX_CHANNELS, 1},
+    {offsetof(ConfigData, motion), sizeof(MotionLimits), 1},
+    {offsetof(ConfigData, wifiCache), sizeof(WiFiFastConnect), 1},
+    {offsetof(ConfigData, model), sizeof(ServoModel) * SERVO_MAX_CHANNELS, 1},
+    {offsetof(ConfigData, correction), sizeof(ServoCorrection) * SERVO_MAX_CHANNELS, 1},
+};
+
+static_assert(sizeof(ConfigPageHeader) + sizeof(ConfigData) + CONFIG_KEY_COUNT * (sizeof(ConfigRecordHeader) + 3) <= CONFIG_PAGE_SIZE,
+              "完整快照必须能放进一页");
+
+static uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t length)
+{
+    crc = ~crc;
+    while (length--)
+    {
+        crc ^= *data++;
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static size_t align4(size_t size)
+{
+    return (size + 3) & ~(size_t)3;
+}
+
+size_t ConfigStore::recordSize(int key)
+{
+    return align4(sizeof(ConfigRecordHeader) + CONFIG_KEYS[key].size);
+}
+
+void ConfigStore::setDefaults(ConfigData &data)
+{
+    memset(&data, 0, sizeof(data));
+    strncpy(data.mqtt.broker, MQTT_BROKER, sizeof(data.mqtt.broker) - 1);
+    data.mqtt.port = MQTT_PORT;
+    strncpy(data.mqtt.username, MQTT_USERNAME, sizeof(data.mqtt.username) - 1);
+    strncpy(data.mqtt.password, MQTT_PASSWORD, sizeof(data.mqtt.password) - 1);
+    for (int ch = 0; ch < SERVO_MAX_CHANNELS; ch++)
+    {
+        data.calibration[ch].minPulseUs = SERVO_MIN_PULSE_US;
+        data.calibration[ch].maxPulseUs = SERVO_MAX_PULSE_US;
+        data.model[ch].speed = SERVO_MODEL_SPEED;
+        data.model[ch].latencyMs = SERVO_MODEL_LATENCY_MS;
+        data.model[ch].deadband = SERVO_MODEL_DEADBAND;
+    }
+    data.motion.maxVelocity = SERVO_MAX_VELOCITY;
+    data.motion.maxAcceleration = SERVO_MAX_ACCELERATION;
+    data.motion.maxJerk = SERVO_MAX_JERK;
+    data.motion.profile = SERVO_MOTION_PROFILE;
+}
+
+bool ConfigStore::begin()
+{
+    setDefaults(_data);
+    _partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, CONFIG_PARTITION_LABEL);
+    if (!_partition)
+    {
+        Serial.println("未找到配置分区，使用默认配置");
+        return false;
+    }
+    _pageCount = _partition->size / CONFIG_PAGE_SIZE;
+    if (_pageCount < 2)
+    {
+        Serial.println("配置分区至少需要两页");
+        _partition = nullptr;
+        return false;
+    }
+
+    // 代数最大的有效页即当前页
+    _activePage = -1;
+    for (int page = 0; page < _pageCount; page++)
+    {
+        ConfigPageHeader header;
+        if (esp_partition_read(_partition, page * CONFIG_PAGE_SIZE, &header, sizeof(header)) != ESP_OK)
+        {
+            continue;
+        }
+        if (header.magic != CONFIG_PAGE_MAGIC || header.format != CONFIG_FORMAT_VERSION ||
+            header.crc != crc32Update(0, (const uint8_t *)&header, offsetof(ConfigPageHeader, crc)))
+        {
+            continue;
+        }
+        if (_activePage < 0 || (int32_t)(header.sequence - _sequence) > 0)
+        {
+            _activePage = page;
+            _sequence = header.sequence;
+        }
+    }
+
+    if (_activePage < 0)
+    {
+        Serial.println("配置分区为空，使用默认配置");
+        importLegacy();
+        return true;
+    }
+    return loadPage(_activePage);
+}
+
+// 顺序扫描一页中的记录。记录先写入暂存区，遇到带提交标志的记录才整体生效
+bool ConfigStore::loadPage(int page)
+{
+    static ConfigData staged;
+    staged = _data;
+    uint32_t stagedVersionMask = 0;
+    size_t base = page * CONFIG_PAGE_SIZE;
+    size_t offset = sizeof(ConfigPageHeader);
+    bool pending = false;
+    bool clean = true;
+
+    while (offset + sizeof(ConfigRecordHeader) <= CONFIG_PAGE_SIZE)
+    {
+        ConfigRecordHeader header;
+        if (esp_partition_read(_partition, base + offset, &header, sizeof(header)) != ESP_OK)
+        {
+            clean = false;
+            break;
+        }
+        if (header.key == CONFIG_KEY_FREE)
+        {
+            break;
+        }
+        size_t size = align4(sizeof(header) + header.length);
+        if (offset + size > CONFIG_PAGE_SIZE)
+        {
+            clean = false;
+            break;
+        }
+
+        // 分块读取负载：计算 CRC，同时把已知键的前缀复制到暂存区；未知键（更新的固件写入）只校验
+        bool known = header.key < CONFIG_KEY_COUNT;
+        uint8_t *dest = known ? (uint8_t *)&staged + CONFIG_KEYS[header.key].offset : nullptr;
+        size_t copy = known ? (header.length < CONFIG_KEYS[header.key].size ? header.length : CONFIG_KEYS[header.key].size) : 0;
+        uint32_t crc = crc32Update(0, (const uint8_t *)&header, offsetof(ConfigRecordHeader, crc));
+        uint8_t chunk[64];
+        size_t done = 0;
+        while (done < header.length)
+        {
+            size_t n = header.length - done < sizeof(chunk) ? header.length - done : sizeof(chunk);
+            if (esp_partition_read(_partition, base + offset + sizeof(header) + done, chunk, n) != ESP_OK)
+            {
+                break;
+            }
+            crc = crc32Update(crc, chunk, n);
+            if (done < copy)
+            {
+                memcpy(dest + done, chunk, copy - done < n ? copy - done : n);
+            }
+            done += n;
+        }
+        if (done < header.length || crc != header.crc)
+        {
+            clean = false;
+            break;
+        }
+
+        if (known && header.version != CONFIG_KEYS[header.key].version)
+        {
+            stagedVersionMask |= 1UL << header.key;
+        }
+        pending = true;
+        offset += size;
+
+        if (header.flags & CONFIG_RECORD_COMMIT)
+        {
+            _data = staged;
+            _dirtyMask |= stagedVersionMask;
+            stagedVersionMask = 0;
+            pending = false;
+        }
+    }
+
+    _writeOffset = offset;
+    if (pending || !clean)
+    {
+        // 掉电留下的半条记录或未提交的批次：丢弃，下一次提交换页
+        Serial.println("配置页末尾有未完成的写入，已丢弃");
+        _stats.corruptRecords++;
+        _needsCompaction = true;
+    }
+    return true;
+}
+
+bool ConfigStore::writeRecord(int page, size_t offset, int key, uint8_t flags, size_t &written)
+{
+    const ConfigKeyInfo &info = CONFIG_KEYS[key];
+    const uint8_t *payload = (const uint8_t *)&_data + info.offset;
+
+    ConfigRecordHeader header = {};
+    header.key = (uint8_t)key;
+    header.version = info.version;
+    header.flags = flags;
+    header.length = (uint16_t)info.size;
+    header.crc = crc32Update(crc32Update(0, (const uint8_t *)&header, offsetof(ConfigRecordHeader, crc)), payload, info.size);
+
+    size_t address = page * CONFIG_PAGE_SIZE + offset;
+    if (esp_partition_write(_partition, address, &header, sizeof(header)) != ESP_OK ||
+        esp_partition_write(_partition, address + sizeof(header), payload, info.size) != ESP_OK)
+    {
+        return false;
+    }
+    written = recordSize(key);
+    return true;
+}
+
+// 在当前页末尾追加修改过的键，最后一条带提交标志；空间不足时换页
+bool ConfigStore::appendRecords(uint32_t keys)
+{
+    size_t needed = 0;
+    for (int key = 0; key < CONFIG_KEY_COUNT; key++)
+    {
+        if (keys & (1UL << key))
+        {
+            needed += recordSize(key);
+        }
+    }
+    if (_activePage < 0 || _needsCompaction || _writeOffset + needed > CONFIG_PAGE_SIZE)
+    {
+        return compact();
+    }
+
+    size_t offset = _writeOffset;
+    uint32_t remaining = keys;
+    for (int key = 0; key < CONFIG_KEY_COUNT; key++)
+    {
+        uint32_t bit = 1UL << key;
+        if (!(keys & bit))
+        {
+            continue;
+        }
+        remaining &= ~bit;
+        size_t written;
+        if (!writeRecord(_activePage, offset, key, remaining ? 0 : CONFIG_RECORD_COMMIT, written))
+        {
+            _needsCompaction = true;
+            return false;
+        }
+        offset += written;
+    }
+    _writeOffset = offset;
+    _stats.appends++;
+    return true;
+}
+
+// 把完整快照写到下一页。页头最后写入，写入完成前掉电时旧页仍是当前页
+bool ConfigStore::compact()
+{
+    int page = _activePage < 0 ? 0 : (_activePage + 1) % _pageCount;
+    size_t base = page * CONFIG_PAGE_SIZE;
+    if (esp_partition_erase_range(_partition, base, CONFIG_PAGE_SIZE) != ESP_OK)
+    {
+        return false;
+    }
+
+    size_t offset = sizeof(ConfigPageHeader);
+    for (int key = 0; key < CONFIG_KEY_COUNT; key++)
+    {
+        size_t written;
+        if (!writeRecord(page, offset, key, key == CONFIG_KEY_COUNT - 1 ? CONFIG_RECORD_COMMIT : 0, written))
+        {
+            return false;
+        }
+        offset += written;
+    }
+
+    ConfigPageHeader header = {};
+    header.magic = CONFIG_PAGE_MAGIC;
+    header.sequence = _sequence + 1;
+    header.format = CONFIG_FORMAT_VERSION;
+    header.crc = crc32Update(0, (const uint8_t *)&header, offsetof(ConfigPageHeader, crc));
+    if (esp_partition_write(_partition, base, &header, sizeof(header)) != ESP_OK)
+    {
+        return false;
+    }
+
+    _activePage = page;
+    _sequence = header.sequence;
+    _writeOffset = offset;
+    _needsCompaction = false;
+    _stats.compactions++;
+    return true;
+}
+
+bool ConfigStore::set(ConfigKey key, const void *value, size_t size)
+{
+    if (key >= CONFIG_KEY_COUNT || size != CONFIG_KEYS[key].size)
+    {
+        return false;
+    }
+    uint8_t *dest = (uint8_t *)&_data + CONFIG_KEYS[key].offset;
+    if (memcmp(dest, value, size) != 0)
+    {
+        memcpy(dest, value, size);
+        _dirtyMask |= 1UL << key;
+    }
+    return true;
+}
+
+bool ConfigStore::commit()
+{
+    if (!_dirtyMask)
+    {
+        return true;
+    }
+    if (!_partition)
+    {
+        return false;
+    }
+    if (!appendRecords(_dirtyMask))
+    {
+        Serial.println("配置写入失败");
+        return false;
+    }
+    _dirtyMask = 0;
+    return true;
+}
+
+bool ConfigStore::reset()
+{
+    setDefaults(_data);
+    _dirtyMask = 0;
+    if (!_partition)
+    {
+        return false;
+    }
+    return compact();
+}
+
+const ConfigStoreStats &ConfigStore::getStats()
+{
+    _stats.sequence = _sequence;
+    _stats.activePage = _activePage;
+    _stats.usedBytes = _activePage < 0 ? 0 : _writeOffset;
+    return _stats;
+}
+
+// 旧版本固件把 WiFiCredentials 原样存放在 EEPROM 地址 0，分区为空时迁移一次
+void ConfigStore::importLegacy()
+{
+    WiFiCredentials legacy;
+    EEPROM.begin(sizeof(WiFiCredentials));
+    EEPROM.get(0, legacy);
+    EEPROM.end();
+
+    if (!memchr(legacy.ssid, 0, sizeof(legacy.ssid)) || !memchr(legacy.password, 0, sizeof(legacy.password)) ||
+        legacy.ssid[0] == 0 || (uint8_t)legacy.ssid[0] == 0xFF)
+    {
+        return;
+    }
+    Serial.println("已从EEPROM迁移WiFi凭证");
+    WiFiCredentials networks[WIFI_MAX_NETWORKS] = {};
+    networks[0] = legacy;
+    set(CONFIG_KEY_WIFI, networks);
+    commit();
+}
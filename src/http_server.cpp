@@ -0,0 +1,554 @@
+#include "http_server.h"
+
+static const struct
+{
+    const char *name;
+    HttpMethod method;
+} METHOD_NAMES[] = {
+    {"GET", HTTP_METHOD_GET},
+    {"HEAD", HTTP_METHOD_HEAD},
+    {"POST", HTTP_METHOD_POST},
+    {"PUT", HTTP_METHOD_PUT},
+    {"DELETE", HTTP_METHOD_DELETE},
+    {"OPTIONS", HTTP_METHOD_OPTIONS},
+};
+
+// 在 [data, data + length) 中查找 pattern，返回偏移，找不到返回 -1
+static long find(const char *data, size_t length, const char *pattern)
+{
+    size_t patternLength = strlen(pattern);
+    for (size_t i = 0; i + patternLength <= length; i++)
+    {
+        if (memcmp(data + i, pattern, patternLength) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+// 查询参数的 URL 解码（%XX 与 '+'）
+static String urlDecode(const char *data, size_t length)
+{
+    String result;
+    result.reserve(length);
+    for (size_t i = 0; i < length; i++)
+    {
+        if (data[i] == '+')
+        {
+            result += ' ';
+        }
+        else if (data[i] == '%' && i + 2 < length && hexValue(data[i + 1]) >= 0 && hexValue(data[i + 2]) >= 0)
+        {
+            result += (char)(hexValue(data[i + 1]) * 16 + hexValue(data[i + 2]));
+            i += 2;
+        }
+        else
+        {
+            result += data[i];
+        }
+    }
+    return result;
+}
+
+void HttpServer::begin()
+{
+    for (int i = 0; i < HTTP_MAX_CONNECTIONS; i++)
+    {
+        _connections[i].active = false;
+        _connections[i].length = 0;
+        _connections[i].pending = nullptr;
+        _connections[i].pendingLength = 0;
+        _connections[i].pendingOffset = 0;
+        _connections[i].closing = false;
+    }
+    _server.begin();
+    _server.setNoDelay(true);
+}
+
+void HttpServer::on(const char *uri, HttpMethod method, THandlerFunction handler)
+{
+    if (_routeCount >= HTTP_MAX_ROUTES)
+    {
+        Serial.println("HTTP路由已满");
+        return;
+    }
+    _routes[_routeCount].uri = uri;
+    _routes[_routeCount].method = method;
+    _routes[_routeCount].handler = handler;
+    _routeCount++;
+}
+
+int HttpServer::getActiveConnections() const
+{
+    int count = 0;
+    for (int i = 0; i < HTTP_MAX_CONNECTIONS; i++)
+    {
+        if (_connections[i].active)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+void HttpServer::handleClient()
+{
+    accept();
+    for (int i = 0; i < HTTP_MAX_CONNECTIONS; i++)
+    {
+        if (_connections[i].active)
+        {
+            service(_connections[i]);
+        }
+    }
+}
+
+// 每次轮询最多接受一个新连接；连接池已满时直接关闭，避免占用协议栈资源
+void HttpServer::accept()
+{
+    WiFiClient client = _server.accept();
+    if (!client)
+    {
+        return;
+    }
+    for (int i = 0; i < HTTP_MAX_CONNECTIONS; i++)
+    {
+        if (!_connections[i].active)
+        {
+            _connections[i].client = client;
+            _connections[i].client.setNoDelay(true);
+            _connections[i].active = true;
+            _connections[i].length = 0;
+            _connections[i].closing = false;
+            _connections[i].lastActivity = millis();
+            _stats.accepted++;
+            return;
+        }
+    }
+    _stats.rejected++;
+    client.stop();
+}
+
+void HttpServer::close(HttpConnection &connection)
+{
+    connection.client.stop();
+    connection.active = false;
+    connection.length = 0;
+    connection.pending = nullptr;
+    connection.pendingLength = 0;
+    connection.pendingOffset = 0;
+    connection.output = String();
+    connection.closing = false;
+}
+
+void HttpServer::closeAfterWrite(HttpConnection &connection)
+{
+    if (connection.pendingLength > 0)
+    {
+        connection.closing = true;
+    }
+    else
+    {
+        close(connection);
+    }
+}
+
+// 写出待写响应体的下一段，每次最多 HTTP_WRITE_CHUNK_SIZE 字节，慢速客户端不会长时间阻塞轮询
+void HttpServer::flush(HttpConnection &connection)
+{
+    size_t remaining = connection.pendingLength - connection.pendingOffset;
+    size_t chunk = remaining < HTTP_WRITE_CHUNK_SIZE ? remaining : HTTP_WRITE_CHUNK_SIZE;
+    size_t written = connection.client.write((const uint8_t *)connection.pending + connection.pendingOffset, chunk);
+    if (written > 0)
+    {
+        connection.pendingOffset += written;
+        connection.lastActivity = millis();
+    }
+    if (connection.pendingOffset >= connection.pendingLength)
+    {
+        connection.pending = nullptr;
+        connection.pendingLength = 0;
+        connection.pendingOffset = 0;
+        connection.output = String();
+    }
+}
+
+// 上一个响应写完之前不读取后续请求，流水线中的响应按顺序返回
+void HttpServer::service(HttpConnection &connection)
+{
+    if (connection.pendingLength > 0)
+    {
+        flush(connection);
+    }
+    if (connection.pendingLength == 0)
+    {
+        if (connection.closing)
+        {
+            close(connection);
+            return;
+        }
+        receive(connection);
+    }
+
+    if (!connection.active)
+    {
+        return;
+    }
+    if (!connection.client.connected())
+    {
+        close(connection);
+    }
+    else if (millis() - connection.lastActivity > HTTP_IDLE_TIMEOUT_MS)
+    {
+        _stats.timeouts++;
+        close(connection);
+    }
+}
+
+// 读取已到达的数据并处理缓冲区中所有完整的请求，不等待未到达的数据
+void HttpServer::receive(HttpConnection &connection)
+{
+    int available = connection.client.available();
+    unsigned long readUs = 0;
+    if (available > 0)
+    {
+        readUs = micros();
+        size_t space = HTTP_REQUEST_BUFFER_SIZE - connection.length;
+        size_t wanted = (size_t)available < space ? (size_t)available : space;
+        int received = connection.client.read((uint8_t *)connection.buffer + connection.length, wanted);
+        if (received > 0)
+        {
+            if (connection.length == 0)
+            {
+                connection.receivedUs = readUs;
+            }
+            connection.length += received;
+            connection.lastActivity = millis();
+        }
+    }
+
+    for (int i = 0; i < HTTP_MAX_PIPELINED_REQUESTS && connection.active && connection.length > 0; i++)
+    {
+        size_t consumed = processRequest(connection);
+        if (consumed == 0 || !connection.active)
+        {
+            break;
+        }
+        connection.length -= consumed;
+        memmove(connection.buffer, connection.buffer + consumed, connection.length);
+        // 流水线中的后续请求最晚在本次读取时到达
+        if (available > 0)
+        {
+            connection.receivedUs = readUs;
+        }
+        if (connection.pendingLength > 0)
+        {
+            break;
+        }
+    }
+}
+
+size_t HttpServer::processRequest(HttpConnection &connection)
+{
+    char *data = connection.buffer;
+    long headerEnd = find(data, connection.length, "\r\n\r\n");
+    if (headerEnd < 0)
+    {
+        if (connection.length >= HTTP_REQUEST_BUFFER_SIZE)
+        {
+            _stats.rejected++;
+            _current = &connection;
+            _method = HTTP_METHOD_GET;
+            _keepAlive = false;
+            _responded = false;
+            _extraHeadersLength = 0;
+            send(431, "text/plain", "Request Header Fields Too Large");
+            closeAfterWrite(connection);
+        }
+        return 0;
+    }
+
+    // 请求行：METHOD SP URI SP VERSION
+    long lineEnd = find(data, headerEnd + 2, "\r\n");
+    long methodEnd = find(data, lineEnd, " ");
+    long uriEnd = methodEnd < 0 ? -1 : find(data + methodEnd + 1, lineEnd - methodEnd - 1, " ");
+    if (methodEnd <= 0 || uriEnd <= 0)
+    {
+        close(connection);
+        return 0;
+    }
+    uriEnd += methodEnd + 1;
+
+    _current = &connection;
+    _method = parseMethod(data, methodEnd);
+    _path = data + methodEnd + 1;
+    _pathLength = uriEnd - methodEnd - 1;
+    _query = nullptr;
+    _queryLength = 0;
+    long queryStart = find(_path, _pathLength, "?");
+    if (queryStart >= 0)
+    {
+        _query = _path + queryStart + 1;
+        _queryLength = _pathLength - queryStart - 1;
+        _pathLength = queryStart;
+    }
+    _headers = data + lineEnd + 2;
+    _headersLength = headerEnd + 2 - (lineEnd + 2);
+    _extraHeadersLength = 0;
+    _responded = false;
+
+    // HTTP/1.1 默认保持连接，HTTP/1.0 默认关闭
+    bool http11 = find(data + uriEnd, lineEnd - uriEnd, "HTTP/1.1") >= 0;
+    String connectionHeader = header("Connection");
+    connectionHeader.toLowerCase();
+    _keepAlive = http11 ? connectionHeader != "close" : connectionHeader == "keep-alive";
+
+    long declaredLength = header("Content-Length").toInt();
+    size_t bodyLength = declaredLength > 0 ? (size_t)declaredLength : 0;
+    size_t total = headerEnd + 4 + bodyLength;
+    if (bodyLength > HTTP_REQUEST_BUFFER_SIZE || total > HTTP_REQUEST_BUFFER_SIZE)
+    {
+        _stats.rejected++;
+        _keepAlive = false;
+        send(413, "text/plain", "Payload Too Large");
+        closeAfterWrite(connection);
+        return 0;
+    }
+    if (connection.length < total)
+    {
+        return 0; // 请求体尚未全部到达
+    }
+    _body = data + headerEnd + 4;
+    _bodyLength = bodyLength;
+
+    // 请求体以 '\0' 结尾，方便处理函数直接解析；缓冲区多留了一个字节
+    char saved = data[total];
+    data[total] = '\0';
+    _stats.requests++;
+    dispatch();
+    data[total] = saved;
+
+    if (!_keepAlive)
+    {
+        closeAfterWrite(connection);
+    }
+    return total;
+}
+
+void HttpServer::dispatch()
+{
+    bool matched = false;
+    for (int i = 0; i < _routeCount && !matched; i++)
+    {
+        const Route &route = _routes[i];
+        if (strlen(route.uri) == _pathLength && memcmp(route.uri, _path, _pathLength) == 0 &&
+            (route.method == HTTP_METHOD_ANY || route.method == _method))
+        {
+            route.handler();
+            matched = true;
+        }
+    }
+    if (!matched && _notFoundHandler)
+    {
+        _notFoundHandler();
+    }
+    if (!_responded)
+    {
+        send(500, "text/plain", "No response");
+    }
+}
+
+HttpMethod HttpServer::parseMethod(const char *name, size_t length)
+{
+    for (const auto &entry : METHOD_NAMES)
+    {
+        if (strlen(entry.name) == length && memcmp(entry.name, name, length) == 0)
+        {
+            return entry.method;
+        }
+    }
+    return HTTP_METHOD_ANY;
+}
+
+bool HttpServer::findQueryParam(const char *name, const char **value, size_t *length) const
+{
+    size_t nameLength = strlen(name);
+    size_t start = 0;
+    while (_query && start < _queryLength)
+    {
+        long end = find(_query + start, _queryLength - start, "&");
+        size_t pairLength = end < 0 ? _queryLength - start : (size_t)end;
+        const char *pair = _query + start;
+        if (pairLength >= nameLength && memcmp(pair, name, nameLength) == 0 &&
+            (pairLength == nameLength || pair[nameLength] == '='))
+        {
+            *value = pairLength == nameLength ? pair + nameLength : pair + nameLength + 1;
+            *length = pairLength == nameLength ? 0 : pairLength - nameLength - 1;
+            return true;
+        }
+        start += pairLength + 1;
+    }
+    return false;
+}
+
+String HttpServer::arg(const char *name) const
+{
+    if (strcmp(name, "plain") == 0)
+    {
+        return _body ? String(_body) : String();
+    }
+    const char *value;
+    size_t length;
+    return findQueryParam(name, &value, &length) ? urlDecode(value, length) : String();
+}
+
+bool HttpServer::hasArg(const char *name) const
+{
+    if (strcmp(name, "plain") == 0)
+    {
+        return _method != HTTP_METHOD_GET && _bodyLength > 0;
+    }
+    const char *value;
+    size_t length;
+    return findQueryParam(name, &value, &length);
+}
+
+// 在原始请求头中按名称查找（不区分大小写），不复制整个请求头
+String HttpServer::header(const char *name) const
+{
+    size_t nameLength = strlen(name);
+    const char *line = _headers;
+    const char *end = _headers + _headersLength;
+    while (line < end)
+    {
+        long lineLength = find(line, end - line, "\r\n");
+        if (lineLength < 0)
+        {
+            break;
+        }
+        if ((size_t)lineLength > nameLength && line[nameLength] == ':' && strncasecmp(line, name, nameLength) == 0)
+        {
+            const char *value = line + nameLength + 1;
+            const char *valueEnd = line + lineLength;
+            while (value < valueEnd && *value == ' ')
+                value++;
+            while (valueEnd > value && valueEnd[-1] == ' ')
+                valueEnd--;
+            return String(value, valueEnd - value);
+        }
+        line += lineLength + 2;
+    }
+    return String();
+}
+
+void HttpServer::sendHeader(const char *name, const char *value)
+{
+    int written = snprintf(_extraHeaders + _extraHeadersLength, sizeof(_extraHeaders) - _extraHeadersLength,
+                           "%s: %s\r\n", name, value);
+    if (written > 0 && _extraHeadersLength + written < sizeof(_extraHeaders))
+    {
+        _extraHeadersLength += written;
+    }
+}
+
+const char *HttpServer::statusText(int code)
+{
+    switch (code)
+    {
+    case 200:
+        return "OK";
+    case 304:
+        return "Not Modified";
+    case 400:
+        return "Bad Request";
+    case 404:
+        return "Not Found";
+    case 413:
+        return "Payload Too Large";
+    case 431:
+        return "Request Header Fields Too Large";
+    case 500:
+        return "Internal Server Error";
+    case 503:
+        return "Service Unavailable";
+    default:
+        return "";
+    }
+}
+
+// 状态行与响应头拼成一次写入，减少 TCP 小包
+void HttpServer::writeHead(int code, const char *contentType, size_t contentLength)
+{
+    char head[HTTP_EXTRA_HEADERS_SIZE + 160];
+    int length = snprintf(head, sizeof(head),
+                          "HTTP/1.1 %d %s\r\n"
+                          "Content-Length: %u\r\n"
+                          "Connection: %s\r\n",
+                          code, statusText(code), (unsigned)contentLength, _keepAlive ? "keep-alive" : "close");
+    if (contentType)
+    {
+        length += snprintf(head + length, sizeof(head) - length, "Content-Type: %s\r\n", contentType);
+    }
+    memcpy(head + length, _extraHeaders, _extraHeadersLength);
+    length += _extraHeadersLength;
+    head[length++] = '\r';
+    head[length++] = '\n';
+    _current->client.write((const uint8_t *)head, length);
+    _extraHeadersLength = 0;
+    _responded = true;
+}
+
+void HttpServer::send(int code, const char *contentType, const String &content)
+{
+    send(code, contentType, content.c_str(), content.length());
+}
+
+void HttpServer::send(int code, const char *contentType, const char *content, size_t length)
+{
+    respond(code, contentType, content, length, false);
+}
+
+// ESP32 的 flash 常量可直接寻址，剩余部分不用复制
+void HttpServer::send_P(int code, const char *contentType, PGM_P content, size_t length)
+{
+    respond(code, contentType, (const char *)content, length, true);
+}
+
+// 响应体的第一段立即写出，其余留给 service() 在之后的轮询中写出
+void HttpServer::respond(int code, const char *contentType, const char *content, size_t length, bool persistent)
+{
+    if (!_current || _responded)
+    {
+        return;
+    }
+    writeHead(code, contentType, length);
+    if (!length || _method == HTTP_METHOD_HEAD)
+    {
+        return;
+    }
+    HttpConnection &connection = *_current;
+    connection.pending = content;
+    connection.pendingLength = length;
+    connection.pendingOffset = 0;
+    flush(connection);
+    if (connection.pendingLength > 0 && !persistent)
+    {
+        // 调用者的缓冲区在返回后失效
+        connection.output = String(content + connection.pendingOffset, length - connection.pendingOffset);
+        connection.pending = connection.output.c_str();
+        connection.pendingLength = connection.output.length();
+        connection.pendingOffset = 0;
+    }
+}
@@ -4,83 +4,127 @@
 
 LEDController ledController;
 
-void LEDController::begin()
+// 下标与 LedStatus 一一对应
+static constexpr LedEffect LED_EFFECTS[STATUS_COUNT] = {
+    {LED_SOLID, LED_LAYER_NETWORK, 0, 1, {0}},                                                      // STATUS_NONE
+    {LED_BLINK, LED_LAYER_NETWORK, 0, 1, {0}},                                                      // STATUS_AP 黑色闪烁
+    {LED_BLINK, LED_LAYER_NETWORK, 0, 1, {LED_BLINK_COLOR_WHITE}},                                  // STATUS_WIFI_DISCONNECTED 白色闪烁
+    {LED_BLINK, LED_LAYER_NETWORK, 0, 1, {LED_BLINK_COLOR_YELLOW}},                                 // STATUS_WIFI_CONNECTING 黄色闪烁
+    {LED_SOLID, LED_LAYER_NETWORK, 0, 1, {LED_BLINK_COLOR_YELLOW}},                                 // STATUS_WIFI_ERROR 黄色常亮
+    {LED_BLINK, LED_LAYER_NETWORK, 0, 1, {LED_BLINK_COLOR_GREEN}},                                  // STATUS_WIFI_CONNECTED 绿色闪烁
+    {LED_BLINK, LED_LAYER_SERVO, 0, 1, {LED_BLINK_COLOR_BLUE}},                                     // STATUS_SERVO_RUNNING 蓝色闪烁
+    {LED_BLINK, LED_LAYER_NOTIFY, LED_SERVO_STOPPED_MS, 1, {LED_BLINK_COLOR_RED}},                  // STATUS_SERVO_STOPPED 红色闪烁
+    {LED_BLINK, LED_LAYER_NOTIFY, LED_NOTIFY_DURATION_MS, 1, {LED_BLINK_COLOR_PURPLE}},             // STATUS_MQTT_RECEIVE 紫色闪烁
+};
+
+static_assert(sizeof(LED_EFFECTS) / sizeof(LED_EFFECTS[0]) == STATUS_COUNT, "LED_EFFECTS 必须覆盖所有 LedStatus");
+
+// 亮度 gamma 校正表（gamma 2.2），64 级
+static const uint8_t GAMMA_TABLE[64] = {
+    0, 0, 0, 0, 1, 1, 1, 2, 3, 4, 4, 5, 7, 8, 9, 11,
+    13, 14, 16, 18, 20, 23, 25, 28, 31, 33, 36, 40, 43, 46, 50, 54,
+    57, 61, 66, 70, 74, 79, 84, 89, 94, 99, 105, 110, 116, 122, 128, 134,
+    140, 147, 153, 160, 167, 174, 182, 189, 197, 205, 213, 221, 229, 238, 246, 255};
+
+static uint32_t scaleColor(uint32_t color, uint8_t level)
 {
-    pixels = Adafruit_NeoPixel(1, LED_PIN, NEO_GRB + NEO_KHZ800);
-    pixels.begin();
-    pixels.setBrightness(50);
+    uint32_t r = ((color >> 16) & 0xFF) * level / 255;
+    uint32_t g = ((color >> 8) & 0xFF) * level / 255;
+    uint32_t b = (color & 0xFF) * level / 255;
+    return (r << 16) | (g << 8) | b;
 }
 
-String LEDController::getCurrentStatus()
+void LEDController::begin()
 {
-    return _currentStatus;
+    pixels = Adafruit_NeoPixel(LED_COUNT, LED_PIN, NEO_GRB + NEO_KHZ800);
+    pixels.begin();
+    pixels.setBrightness(50);
+    _frameValid = false;
 }
 
-void LEDController::changeStatus(String status)
+// 状态放到所属的层并重新开始动画；同一状态重复设置只刷新提示类状态的到期时间
+void LEDController::changeStatus(LedStatus status)
 {
-    _currentStatus = status;
-    if (status == STATUS_AP)
-    {
-        blink(0); // 黑色闪烁
-    }
-    else if (status == STATUS_WIFI_DISCONNECTED)
-    {
-        blink(LED_BLINK_COLOR_WHITE); // 白色闪烁
-    }
-    else if (status == STATUS_WIFI_CONNECTING)
-    {
-        blink(LED_BLINK_COLOR_YELLOW); // 黄色闪烁
-    }
-    else if (status == STATUS_WIFI_ERROR)
-    {
-        light(LED_BLINK_COLOR_YELLOW); // 黄色常亮
-    }
-    else if (status == STATUS_WIFI_CONNECTED)
-    {
-        blink(LED_BLINK_COLOR_GREEN); // 绿色闪烁
-    }
-    else if (status == STATUS_SERVO_RUNNING)
-    {
-        blink(LED_BLINK_COLOR_BLUE); // 蓝色闪烁
-    }
-    else if (status == STATUS_MQTT_RECEIVE)
+    if (status >= STATUS_COUNT)
     {
-        blink(LED_BLINK_COLOR_PURPLE); // 紫色闪烁
+        return;
     }
-    else if (status == STATUS_SERVO_STOPPED)
+    const LedEffect &effect = LED_EFFECTS[status];
+    if (_layers[effect.layer] == status && effect.durationMs == 0)
     {
-        blink(LED_BLINK_COLOR_RED); // 红色闪烁
+        return;
     }
+    _layers[effect.layer] = status;
+    _since[effect.layer] = millis();
 }
 
-void LEDController::blink(uint32_t color)
+void LEDController::clearLayer(LedLayer layer)
 {
-    unsigned long currentTime = millis();
+    _layers[layer] = STATUS_NONE;
+}
 
-    if (currentTime - lastBlinkTime >= 200)
+void LEDController::expireLayers(unsigned long now)
+{
+    for (int layer = 0; layer < LED_LAYER_COUNT; layer++)
     {
-        lastBlinkTime = currentTime;
-        blinkState = !blinkState;
-
-        if (blinkState)
+        uint16_t duration = LED_EFFECTS[_layers[layer]].durationMs;
+        if (duration && now - _since[layer] >= duration)
         {
-            pixels.setPixelColor(0, color);
+            _layers[layer] = STATUS_NONE;
         }
-        else
+    }
+}
+
+LedStatus LEDController::getCurrentStatus()
+{
+    expireLayers(millis());
+    for (int layer = LED_LAYER_COUNT - 1; layer > 0; layer--)
+    {
+        if (_layers[layer] != STATUS_NONE)
         {
-            pixels.setPixelColor(0, 0);
+            return _layers[layer];
         }
-        pixels.show();
     }
+    return _layers[LED_LAYER_NETWORK];
 }
 
-void LEDController::light(uint32_t color)
+uint32_t LEDController::renderFrame(const LedEffect &effect, unsigned long elapsed)
 {
-    pixels.setPixelColor(0, color);
-    pixels.show();
+    switch (effect.pattern)
+    {
+    case LED_BLINK:
+        return (elapsed / LED_BLINK_INTERVAL_MS) & 1 ? 0 : effect.colors[0];
+    case LED_BREATHE:
+    {
+        // 亮度量化为 LED_BREATHE_STEPS 级，颜色每级才变化一次，一个周期只刷新 2 * LED_BREATHE_STEPS 次
+        const unsigned long half = LED_BREATHE_PERIOD_MS / 2;
+        unsigned long phase = elapsed % LED_BREATHE_PERIOD_MS;
+        unsigned long ramp = phase < half ? phase : LED_BREATHE_PERIOD_MS - phase;
+        unsigned long step = ramp * LED_BREATHE_STEPS / (half + 1);
+        return scaleColor(effect.colors[0], GAMMA_TABLE[step * 63 / (LED_BREATHE_STEPS - 1)]);
+    }
+    case LED_CYCLE:
+        return effect.colors[(elapsed / LED_PATTERN_STEP_MS) % effect.colorCount];
+    case LED_SOLID:
+    default:
+        return effect.colors[0];
+    }
 }
 
 void LEDController::update()
 {
-    changeStatus(_currentStatus);
-}
\ No newline at end of file
+    unsigned long now = millis();
+    LedStatus status = getCurrentStatus();
+    const LedEffect &effect = LED_EFFECTS[status];
+    uint32_t color = renderFrame(effect, now - _since[effect.layer]);
+
+    // 颜色不变时不发送，避免每次刷新都触发一次 RMT 传输
+    if (_frameValid && color == _shownColor)
+    {
+        return;
+    }
+    pixels.setPixelColor(0, color);
+    pixels.show();
+    _shownColor = color;
+    _frameValid = true;
+}
@@ -2,18 +2,21 @@
 #include "types.h"
 #include "led_control.h"
 #include "servo_control.h"
+#include "servo_task.h"
 #include <WiFi.h>
-#include <WebServer.h>
-#include <EEPROM.h>
+#include "config_store.h"
 #include <PubSubClient.h>
 #include <web_server.h>
 #include <mqtt_client.h>
+#include "ws_server.h"
 #include "wifi_manager.h"
+#include "scheduler.h"
+#include "boot_profiler.h"
 
 // 全局变量
 DeviceStatus deviceStatus;
 WiFiCredentials credentials;
-WebServer server(80);
+HttpServer server(80);
 extern WebServerManager webServerManager;
 
 // WiFi重连相关变量
@@ -24,10 +27,31 @@ const unsigned long SHORT_PRESS_TIME = 1000; // 1秒内的按压被认为是短
 static unsigned long btnPressTime = 0;
 static bool btnPressed = false;
 
+static void checkResetButton()
+{
+  int btnState = digitalRead(RESET_PIN);
+  if (btnState == LOW && !btnPressed)
+  {
+    btnPressed = true;
+    btnPressTime = millis();
+  }
+
+  if (btnState == HIGH && btnPressed)
+  {
+    unsigned long pressDuration = millis() - btnPressTime;
+    if (pressDuration < SHORT_PRESS_TIME)
+    {
+      wifiManager.reconnect();
+    }
+    btnPressed = false;
+  }
+}
+
 void setup()
 {
   Serial.begin(115200);
-  EEPROM.begin(sizeof(WiFiCredentials));
+  configStore.begin();
+  bootProfiler.mark(BOOT_CONFIG);
   // 初始化所有管理器
   /**
    * Adafruit_NeoPixel 库在初始化时会配置 RMT（Remote Control）通道，这是 ESP32 的一个硬件特性
@@ -35,46 +59,56 @@ void setup()
    * 当 LED 控制器先初始化时，可能会占用舵机所需的 RMT 通道，导致舵机初始化时出现资源冲突
    * 所以 舵机控制器的初始化放在前面
    */
-  servoController.begin(SERVO_PIN);
+  static const int servoPins[] = SERVO_PINS;
+  servoController.begin(servoPins, sizeof(servoPins) / sizeof(servoPins[0]), configStore.data().calibration,
+                        configStore.data().model, configStore.data().correction);
+  servoController.setMotionLimits(configStore.data().motion);
+  servoTask.begin();
+  bootProfiler.mark(BOOT_SERVO);
   ledController.begin();
-  wifiManager.begin();
-  mqttManager.begin();
-  webServerManager.begin();
+  bootProfiler.mark(BOOT_LED);
 
   // 设置按键引脚
   pinMode(RESET_PIN, INPUT_PULLUP);
 
-  // 尝试连接WiFi或启动AP模式
+  // 先发起 WiFi 连接（或启动AP模式），关联和 DHCP 在后台进行，同时初始化其余服务；
+  // MQTT 在 WiFi 连上后的第一次轮询时连接，HTTP/WebSocket 服务已在监听，联网即可用
+  wifiManager.begin();
   if (!wifiManager.connect())
   {
     wifiManager.setupAP();
   }
-}
-
-void loop()
-{
-  // 更新所有管理器状态
-  wifiManager.update();
-  servoController.update();
-  mqttManager.update();
-  ledController.update();
-  webServerManager.handleClient();
+  bootProfiler.mark(BOOT_WIFI_STARTED);
+  mqttManager.begin();
+  webServerManager.begin();
+  wsManager.begin();
+  bootProfiler.mark(BOOT_NETWORK_INIT);
 
-   // 按键检测
-  int btnState = digitalRead(RESET_PIN);
-  if (btnState == LOW && !btnPressed)
+  // 注册调度任务：舵机按固定节拍运行，网络轮询只占用节拍之间的空闲时间。
+  // 双核模式下舵机节拍由独立任务驱动，调度器只负责网络等轮询任务
+  if (!servoTask.isDualCore())
   {
-    btnPressed = true;
-    btnPressTime = millis();
+    scheduler.addTask("servo", []()
+                      { servoTask.tick(); }, SERVO_TICK_INTERVAL_US, TASK_PERIODIC, 0);
   }
+  scheduler.addTask("mqtt", []()
+                    { mqttManager.update(); }, MQTT_POLL_INTERVAL_US, TASK_SLACK, 1, MQTT_POLL_DEADLINE_US);
+  scheduler.addTask("ws", []()
+                    { wsManager.update(); }, WS_POLL_INTERVAL_US, TASK_SLACK, 2, WS_POLL_DEADLINE_US);
+  scheduler.addTask("http", []()
+                    { webServerManager.handleClient(); }, HTTP_POLL_INTERVAL_US, TASK_SLACK, 3, HTTP_POLL_DEADLINE_US);
+  scheduler.addTask("led", []()
+                    { ledController.update(); }, LED_UPDATE_INTERVAL_US, TASK_SLACK, 4);
+  scheduler.addTask("wifi", []()
+                    { wifiManager.update(); }, WIFI_POLL_INTERVAL_US, TASK_SLACK, 5);
+  scheduler.addTask("button", checkResetButton, BUTTON_POLL_INTERVAL_US, TASK_SLACK, 6);
 
-  if (btnState == HIGH && btnPressed)
-  {
-    unsigned long pressDuration = millis() - btnPressTime;
-    if (pressDuration < SHORT_PRESS_TIME)
-    {
-      wifiManager.reconnect();
-    }
-    btnPressed = false;
-  }
+  Serial.print("复位原因: ");
+  Serial.println(bootProfiler.getResetReason());
+  bootProfiler.mark(BOOT_SETUP_DONE);
+}
+
+void loop()
+{
+  scheduler.run();
 }
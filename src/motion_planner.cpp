@@ -0,0 +1,164 @@
+#include "motion_planner.h"
+
+uint32_t MotionPlanner::_trapezoidTable[EASING_TABLE_SIZE + 1];
+uint32_t MotionPlanner::_scurveTable[EASING_TABLE_SIZE + 1];
+uint32_t MotionPlanner::_easeInOutTable[EASING_TABLE_SIZE + 1];
+uint32_t MotionPlanner::_easeInTable[EASING_TABLE_SIZE + 1];
+uint32_t MotionPlanner::_easeOutTable[EASING_TABLE_SIZE + 1];
+bool MotionPlanner::_tablesReady = false;
+
+void MotionPlanner::initTables()
+{
+    for (int i = 0; i <= EASING_TABLE_SIZE; i++)
+    {
+        float u = (float)i / EASING_TABLE_SIZE;
+        // 梯形：r(u) = u，积分 u²/2
+        _trapezoidTable[i] = (uint32_t)(u * u / 2 * 65536 + 0.5f);
+        // S 曲线：r(u) = 3u² - 2u³，积分 u³ - u⁴/2
+        _scurveTable[i] = (uint32_t)((u * u * u - u * u * u * u / 2) * 65536 + 0.5f);
+        _easeInOutTable[i] = (uint32_t)(u * u * (3 - 2 * u) * 65536 + 0.5f);
+        _easeInTable[i] = (uint32_t)(u * u * 65536 + 0.5f);
+        _easeOutTable[i] = (uint32_t)((1 - (1 - u) * (1 - u)) * 65536 + 0.5f);
+    }
+    _tablesReady = true;
+}
+
+// 规划阶段只在收到命令时执行一次，可以使用浮点；采样阶段全部为整数运算
+void MotionPlanner::plan(const MotionLimits &limits, int32_t from, int32_t to, MotionSegment &segment)
+{
+    if (!_tablesReady)
+    {
+        initTables();
+    }
+
+    segment.from = from;
+    segment.distance = to - from;
+    segment.profile = limits.profile;
+    segment.easing = -1;
+    segment.rampDistance = 0;
+    segment.rampMs = 0;
+    segment.cruiseMs = 0;
+    segment.durationMs = 0;
+
+    float distance = abs(segment.distance) / 100.0f;
+    if (distance <= 0 || limits.maxVelocity <= 0 || limits.maxAcceleration <= 0)
+    {
+        return;
+    }
+
+    bool scurve = limits.profile == PROFILE_SCURVE && limits.maxJerk > 0;
+
+    // 以峰值速度 v 加速所需时间：梯形为 v/a；S 曲线峰值加速度为 1.5v/t、峰值加加速度为 6v/t²
+    float velocity = limits.maxVelocity;
+    float rampTime = scurve ? max(1.5f * velocity / limits.maxAcceleration, sqrtf(6 * velocity / limits.maxJerk))
+                            : velocity / limits.maxAcceleration;
+
+    if (velocity * rampTime > distance)
+    {
+        // 距离太短达不到最大速度：在两种约束下分别求峰值速度，取较小者
+        float accelLimited = sqrtf(distance * limits.maxAcceleration / (scurve ? 1.5f : 1.0f));
+        velocity = accelLimited;
+        if (scurve)
+        {
+            float jerkLimited = powf(distance * sqrtf(limits.maxJerk / 6), 2.0f / 3.0f);
+            velocity = min(accelLimited, jerkLimited);
+        }
+        rampTime = distance / velocity;
+    }
+
+    float cruiseTime = (distance - velocity * rampTime) / velocity;
+
+    segment.rampMs = max((uint32_t)(rampTime * 1000 + 0.5f), (uint32_t)1);
+    segment.cruiseMs = (uint32_t)(max(cruiseTime, 0.0f) * 1000 + 0.5f);
+    segment.durationMs = 2 * segment.rampMs + segment.cruiseMs;
+    segment.rampDistance = min((int32_t)(velocity * rampTime * 100 + 0.5f), (int32_t)abs(segment.distance));
+}
+
+// 在 durationMs 内按缓动曲线从 from 到 to，不受运动限制约束
+void MotionPlanner::planTimed(int32_t from, int32_t to, uint32_t durationMs, MotionEasing easing, MotionSegment &segment)
+{
+    if (!_tablesReady)
+    {
+        initTables();
+    }
+
+    segment.from = from;
+    segment.distance = to - from;
+    segment.profile = PROFILE_TRAPEZOIDAL;
+    segment.easing = easing < EASE_COUNT ? easing : EASE_LINEAR;
+    segment.rampDistance = 0;
+    segment.rampMs = 0;
+    segment.cruiseMs = 0;
+    segment.durationMs = durationMs;
+}
+
+uint32_t MotionPlanner::rampIntegral(MotionProfileType profile, uint32_t t, uint32_t rampMs)
+{
+    return lookup(profile == PROFILE_SCURVE ? _scurveTable : _trapezoidTable, t, rampMs);
+}
+
+uint32_t MotionPlanner::lookup(const uint32_t *table, uint32_t t, uint32_t periodMs)
+{
+    // Q8 表索引，在相邻两项之间线性插值
+    uint32_t index = (uint32_t)(((uint64_t)t * EASING_TABLE_SIZE << 8) / periodMs);
+    uint32_t i = index >> 8;
+    if (i >= EASING_TABLE_SIZE)
+    {
+        return table[EASING_TABLE_SIZE];
+    }
+    uint32_t frac = index & 0xFF;
+    return table[i] + (((table[i + 1] - table[i]) * frac) >> 8);
+}
+
+int32_t MotionPlanner::sample(const MotionSegment &segment, uint32_t elapsedMs)
+{
+    if (elapsedMs >= segment.durationMs)
+    {
+        return segment.from + segment.distance;
+    }
+
+    if (segment.easing >= 0)
+    {
+        uint32_t progress; // Q16
+        switch (segment.easing)
+        {
+        case EASE_STEP:
+            return segment.from + segment.distance;
+        case EASE_IN_OUT:
+            progress = lookup(_easeInOutTable, elapsedMs, segment.durationMs);
+            break;
+        case EASE_IN:
+            progress = lookup(_easeInTable, elapsedMs, segment.durationMs);
+            break;
+        case EASE_OUT:
+            progress = lookup(_easeOutTable, elapsedMs, segment.durationMs);
+            break;
+        default:
+            progress = (uint32_t)(((uint64_t)elapsedMs << 16) / segment.durationMs);
+            break;
+        }
+        return segment.from + (int32_t)(((int64_t)segment.distance * progress) >> 16);
+    }
+
+    int32_t total = abs(segment.distance);
+    int32_t travelled;
+    uint32_t cruiseEnd = segment.rampMs + segment.cruiseMs;
+
+    if (elapsedMs < segment.rampMs)
+    {
+        travelled = (int32_t)(((int64_t)segment.rampDistance * rampIntegral(segment.profile, elapsedMs, segment.rampMs)) >> 16);
+    }
+    else if (elapsedMs < cruiseEnd)
+    {
+        int32_t cruiseDistance = total - segment.rampDistance;
+        travelled = segment.rampDistance / 2 +
+                    (int32_t)((int64_t)cruiseDistance * (elapsedMs - segment.rampMs) / segment.cruiseMs);
+    }
+    else
+    {
+        uint32_t remaining = segment.durationMs - elapsedMs;
+        travelled = total - (int32_t)(((int64_t)segment.rampDistance * rampIntegral(segment.profile, remaining, segment.rampMs)) >> 16);
+    }
+
+    return segment.distance >= 0 ? segment.from + travelled : segment.from - travelled;
+}
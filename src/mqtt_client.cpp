@@ -1,16 +1,90 @@
 #include "mqtt_client.h"
 #include "servo_control.h"
-#include <led_control.h>
+#include "command_router.h"
+#include "static_allocator.h"
+#include "binary_protocol.h"
+#include "config_store.h"
+#include "boot_profiler.h"
+#include "servo_task.h"
+#include "trace.h"
 
 extern DeviceStatus deviceStatus;
 extern WiFiCredentials credentials;
 
 MQTTClientManager mqttManager;
 
+// 命令解析用的静态内存池与文档，解析过程不使用堆
+static StaticPoolAllocator<MQTT_JSON_POOL_SIZE> commandAllocator;
+static JsonDocument commandDoc(&commandAllocator);
+// 输入过滤器：只保留命令需要的字段，其余字段在解析时直接跳过
+static JsonDocument commandFilter;
+// 遥测文档同样使用静态内存池
+static StaticPoolAllocator<TELEMETRY_BUFFER_SIZE * 2> telemetryAllocator;
+static JsonDocument telemetryDoc(&telemetryAllocator);
+// 两种命令各自去重：JSON 的 seq 为 32 位，二进制帧的序号为 16 位
+static SequenceWindow jsonWindow(32);
+static SequenceWindow binaryWindow(16);
+
+int32_t SequenceWindow::distance(uint32_t sequence) const
+{
+    int shift = 32 - _bits;
+    return (int32_t)((sequence - _highest) << shift) >> shift;
+}
+
+bool SequenceWindow::isDuplicate(uint32_t sequence, uint8_t &result) const
+{
+    if (!_valid)
+    {
+        return false;
+    }
+    int32_t d = distance(sequence);
+    if (d > 0 || -d >= WINDOW || !(_seen & (1ULL << -d)))
+    {
+        return false;
+    }
+    result = _results[sequence % WINDOW];
+    return true;
+}
+
+void SequenceWindow::record(uint32_t sequence, uint8_t result)
+{
+    int32_t d = _valid ? distance(sequence) : WINDOW;
+    if (d > 0)
+    {
+        // 新的最高序号，窗口前移
+        _seen = d >= WINDOW ? 0 : _seen << d;
+        _seen |= 1;
+        _highest = sequence;
+    }
+    else if (-d < WINDOW)
+    {
+        // 窗口内乱序到达
+        _seen |= 1ULL << -d;
+    }
+    else
+    {
+        _seen = 1;
+        _highest = sequence;
+    }
+    _valid = true;
+    _results[sequence % WINDOW] = result;
+}
+
 void MQTTClientManager::begin()
 {
+    commandFilter["command"] = true;
+    commandFilter["position"] = true;
+    commandFilter["restore"] = true;
+    commandFilter["channel"] = true;
+    commandFilter["group"] = true;
+    commandFilter["pwd"] = true;
+    commandFilter["frames"] = true;
+    commandFilter["loops"] = true;
+    commandFilter["seq"] = true;
+
     mqttClient.setClient(espClient);
-    setupMQTT();
+    mqttClient.setCallback(callback);
+    mqttClient.setKeepAlive(MQTT_KEEPALIVE);
 }
 
 bool MQTTClientManager::setupMQTT()
@@ -27,10 +101,9 @@ bool MQTTClientManager::setupMQTT()
     Serial.print("WiFi IP: ");
     Serial.println(WiFi.localIP());
 
-    // 设置MQTT服务器
-    mqttClient.setServer(MQTT_BROKER, MQTT_PORT);
-    mqttClient.setCallback(callback);
-    mqttClient.setKeepAlive(MQTT_KEEPALIVE);
+    // 设置MQTT服务器，参数来自配置存储（默认值见 config.h）
+    const MqttSettings &settings = configStore.data().mqtt;
+    mqttClient.setServer(settings.broker, settings.port);
 
     // 生成唯一的客户端ID
     String client_id = "esp32-servo-" + String(WiFi.macAddress());
@@ -38,12 +111,14 @@ bool MQTTClientManager::setupMQTT()
     Serial.println(client_id);
 
     // 尝试连接MQTT服务器
-    if (mqttClient.connect(client_id.c_str(), MQTT_USERNAME, MQTT_PASSWORD, nullptr, 0, true, nullptr, 0))
+    if (mqttClient.connect(client_id.c_str(), settings.username, settings.password, nullptr, 0, true, nullptr, 0))
     {
         Serial.println("MQTT连接成功");
+        bootProfiler.mark(BOOT_MQTT_CONNECTED);
+        telemetryValid = false;
 
-        // 订阅主题并检查结果
-        if (mqttClient.subscribe(MQTT_TOPIC))
+        // 订阅主题并检查结果。会话不清除，断线期间的 QoS1 命令重连后补投，重复投递由序号去重
+        if (mqttClient.subscribe(MQTT_TOPIC, MQTT_COMMAND_QOS))
         {
             Serial.println("成功订阅主题: " + String(MQTT_TOPIC));
             deviceStatus.mqttTopic = MQTT_TOPIC;
@@ -52,6 +127,10 @@ bool MQTTClientManager::setupMQTT()
         {
             Serial.println("订阅主题失败");
         }
+        if (!mqttClient.subscribe(MQTT_BINARY_TOPIC, MQTT_COMMAND_QOS))
+        {
+            Serial.println("订阅二进制命令主题失败");
+        }
         return true;
     }
 
@@ -97,113 +176,367 @@ bool MQTTClientManager::setupMQTT()
 
 void MQTTClientManager::callback(char *topic, byte *payload, unsigned int length)
 {
-    String message;
-    for (int i = 0; i < length; i++)
+    // 回执中的延迟从这里开始计算
+    unsigned long receivedUs = micros();
+    if (strcmp(topic, MQTT_BINARY_TOPIC) == 0)
+    {
+        TRACE_BEGIN(TRACE_SOURCE_MQTT_BINARY);
+        handleBinaryCommand(payload, length, receivedUs);
+    }
+    else
     {
-        message += (char)payload[i];
+        TRACE_BEGIN(TRACE_SOURCE_MQTT);
+        handleJsonCommand(payload, length, receivedUs);
     }
+}
 
-    Serial.println("收到MQTT消息: " + message);
+// 带序号的命令：处理过的序号直接重发首次的回执，不再执行；否则在命令上附带回执信息
+bool MQTTClientManager::acceptSequence(SequenceWindow &window, Command &cmd, uint8_t route, uint32_t sequence, unsigned long receivedUs)
+{
+    cmd.ack.route = route;
+    cmd.ack.sequence = sequence;
+    cmd.ack.receivedUs = receivedUs;
+    cmd.ack.appliedUs = receivedUs;
 
-    JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, message);
+    uint8_t previous;
+    if (window.isDuplicate(sequence, previous))
+    {
+        mqttManager.duplicates++;
+        mqttManager.publishAck(cmd.ack, previous, true);
+        return false;
+    }
+    return true;
+}
+
+// 记录处理结果。成功的命令在舵机任务执行后回执，其余立即回执；
+// 被拒绝（队列满）的序号不记录，控制端可以用同一序号重试
+void MQTTClientManager::finishCommand(SequenceWindow &window, const Command &cmd, CommandResult result)
+{
+    if (!cmd.ack.route)
+    {
+        return;
+    }
+    if (result != COMMAND_REJECTED)
+    {
+        window.record(cmd.ack.sequence, result);
+    }
+    if (result != COMMAND_OK)
+    {
+        CommandAck ack = cmd.ack;
+        ack.appliedUs = micros();
+        mqttManager.publishAck(ack, result, false);
+    }
+}
+
+// JSON 回执 {"seq":N,"result":R,"latency_us":L}，重复投递为 {"seq":N,"result":R,"dup":true}；
+// 二进制命令的回执为 BINARY_ACK_SIZE 字节的回执帧
+void MQTTClientManager::publishAck(const CommandAck &ack, uint8_t result, bool duplicate)
+{
+    if (!mqttClient.connected())
+    {
+        return;
+    }
+    uint32_t latencyUs = duplicate ? 0 : ack.appliedUs - ack.receivedUs;
+    if (ack.route == ACK_ROUTE_BINARY)
+    {
+        uint8_t frame[BINARY_ACK_SIZE];
+        encodeBinaryAck((uint16_t)ack.sequence, result, duplicate ? BIN_ACK_DUPLICATE : 0, latencyUs, frame);
+        mqttClient.publish(MQTT_BINARY_ACK_TOPIC, frame, sizeof(frame));
+        return;
+    }
+
+    char buffer[64];
+    int length;
+    if (duplicate)
+    {
+        length = snprintf(buffer, sizeof(buffer), "{\"seq\":%lu,\"result\":%u,\"dup\":true}",
+                          (unsigned long)ack.sequence, result);
+    }
+    else
+    {
+        length = snprintf(buffer, sizeof(buffer), "{\"seq\":%lu,\"result\":%u,\"latency_us\":%lu}",
+                          (unsigned long)ack.sequence, result, (unsigned long)latencyUs);
+    }
+    mqttClient.publish(MQTT_ACK_TOPIC, (const uint8_t *)buffer, length);
+}
+
+// 取回舵机任务已执行或已被覆盖的命令并回执。未连接时同样取出，回执丢弃，避免队列积压
+void MQTTClientManager::publishAcks()
+{
+    CommandAck ack;
+    while (servoTask.pollAck(ack))
+    {
+        publishAck(ack, ack.result, false);
+    }
+}
+
+// 二进制帧：定长解码，认证标签代替 pwd 字段
+// 序号为 0 的帧不回执也不去重
+void MQTTClientManager::handleBinaryCommand(byte *payload, unsigned int length, unsigned long receivedUs)
+{
+    BinaryFrame frame;
+    BinaryDecodeResult result = decodeBinaryFrame(payload, length, credentials.password, frame);
+    if (result != BIN_OK)
+    {
+        TRACE_COUNT(result == BIN_BAD_TAG ? TRACE_AUTH_FAILURES : TRACE_PARSE_FAILURES);
+        Serial.println(result == BIN_BAD_TAG ? "二进制命令认证失败" : "二进制命令长度错误");
+        return;
+    }
+    // 定长帧的解码与认证标签校验是同一步
+    TRACE_STAGE(TRACE_PARSE);
+    TRACE_STAGE(TRACE_AUTH);
+
+    Command cmd;
+    switch (frame.opcode)
+    {
+    case BIN_OP_START:
+        cmd.type = CMD_START;
+        break;
+    case BIN_OP_STOP:
+        cmd.type = CMD_STOP;
+        break;
+    case BIN_OP_POSITION:
+        cmd.type = CMD_POSITION;
+        break;
+    default:
+        cmd.type = CMD_UNKNOWN;
+        break;
+    }
+    cmd.position = frame.position;
+    cmd.restore = (frame.flags & BIN_FLAG_RESTORE) != 0;
+    cmd.channel = (frame.flags & BIN_FLAG_GROUP) ? -1 : frame.channel;
+    cmd.group = (frame.flags & BIN_FLAG_GROUP) ? frame.channel : -1;
+    cmd.loops = 0;
+    cmd.frameCount = 0;
+    cmd.ack.route = ACK_ROUTE_NONE;
+    if (frame.sequence && !acceptSequence(binaryWindow, cmd, ACK_ROUTE_BINARY, frame.sequence, receivedUs))
+    {
+        return;
+    }
+    finishCommand(binaryWindow, cmd, commandRouter.dispatch(cmd));
+}
+
+void MQTTClientManager::handleJsonCommand(byte *payload, unsigned int length, unsigned long receivedUs)
+{
+#if COMMAND_LOG
+    Serial.print("收到MQTT消息: ");
+    Serial.write(payload, length);
+    Serial.println();
+#endif
+
+    // 直接从 payload 缓冲区解析，结果存放在静态内存池中
+    DeserializationError error = deserializeJson(commandDoc, payload, length, DeserializationOption::Filter(commandFilter));
 
     if (error)
     {
+        TRACE_COUNT(TRACE_PARSE_FAILURES);
         Serial.println("解析JSON失败");
         return;
     }
 
-    MQTTCommand cmd;
-    cmd.command = doc["command"].as<String>();
-    cmd.position = doc["position"].as<int>();
-    cmd.restore = doc["restore"].as<int>();
-    cmd.pwd = doc["pwd"].as<String>();
+    Command cmd;
+    CommandResult result = commandRouter.parse(commandDoc, cmd);
+    if (result == COMMAND_MISSING)
+    {
+        return;
+    }
+    if (result == COMMAND_OK)
+    {
+        TRACE_STAGE(TRACE_PARSE);
+    }
+    else
+    {
+        TRACE_COUNT(TRACE_PARSE_FAILURES);
+    }
 
     // 验证密码
-    if (cmd.command != nullptr && cmd.command != "" && cmd.command != "null")
+    const char *pwd = commandDoc["pwd"];
+    if (!pwd || strcmp(pwd, credentials.password) != 0)
     {
-        if (cmd.pwd != String(credentials.password))
-        {
-            Serial.println("密码错误:" + cmd.pwd);
-            return;
-        }
+        TRACE_COUNT(TRACE_AUTH_FAILURES);
+        Serial.print("密码错误:");
+        Serial.println(pwd ? pwd : "");
+        return;
     }
+    TRACE_STAGE(TRACE_AUTH);
 
-    // 处理命令
-    if (cmd.command == "start")
+    // seq 可选，没有时不回执也不去重
+    JsonVariantConst seq = commandDoc["seq"];
+    if (seq.is<uint32_t>() && !acceptSequence(jsonWindow, cmd, ACK_ROUTE_JSON, seq.as<uint32_t>(), receivedUs))
     {
-        servoController.setRunning(true);
-        deviceStatus.isServoRunning = true;
-        ledController.changeStatus(STATUS_SERVO_RUNNING);
+        Serial.println("重复的命令，已忽略");
+        return;
     }
-    else if (cmd.command == "stop")
+
+    if (result == COMMAND_OK)
     {
-        servoController.setRunning(false);
-        deviceStatus.isServoRunning = false;
-        if (deviceStatus.isWiFiConnected)
-        {
-            ledController.changeStatus(STATUS_WIFI_CONNECTED);
-        }
-        else
-        {
-            ledController.changeStatus(STATUS_WIFI_DISCONNECTED);
-        }
+        result = commandRouter.dispatch(cmd);
+    }
+    if (result != COMMAND_OK)
+    {
+        Serial.println(CommandRouter::resultMessage(result));
+    }
+    finishCommand(jsonWindow, cmd, result);
+}
+
+// WiFi 连上后立即连接，失败后按 RECONNECT_INTERVAL 重试；WiFi 断开时重置，下次连上仍立即连接
+void MQTTClientManager::checkConnection()
+{
+    if (!deviceStatus.isWiFiConnected)
+    {
+        retryPending = false;
+        return;
+    }
+    if (mqttClient.connected())
+    {
+        return;
     }
-    else if (cmd.command == "position")
+    unsigned long now = millis();
+    if (retryPending && now - lastReconnectAttempt < RECONNECT_INTERVAL)
     {
-        servoController.setRunning(false);
-        deviceStatus.isServoRunning = false;
+        return;
+    }
+    retryPending = true;
+    lastReconnectAttempt = now;
+    TRACE_COUNT(TRACE_MQTT_RECONNECTS);
+    Serial.println("MQTT未连接，尝试连接");
+    setupMQTT();
+}
 
-        String lastStatus = ledController.getCurrentStatus();
-        ledController.changeStatus(STATUS_MQTT_RECEIVE);
+void MQTTClientManager::captureTelemetry(TelemetrySnapshot &snapshot)
+{
+    const ServoSnapshot &servo = servoTask.snapshot();
+    snapshot.running = servo.runningMask != 0;
+    snapshot.moving = servo.movingMask != 0;
+    snapshot.sequence = servo.sequenceMask != 0;
+    for (int ch = 0; ch < SERVO_MAX_CHANNELS; ch++)
+    {
+        const ServoChannelStatus &status = servo.channels[ch];
+        bool valid = ch < servo.channelCount;
+        snapshot.position[ch] = valid ? status.position : 0;
+        snapshot.target[ch] = valid ? status.target : 0;
+        snapshot.estimate[ch] = valid ? status.estimate : 0;
+        snapshot.arrival[ch] = valid ? (int16_t)min(status.arrivalMs, (uint32_t)32767) : 0;
+    }
+}
 
-        int targetPosition = constrain(cmd.position, 0, 180);
-        int lastPosition = deviceStatus.servoPosition;
+uint8_t MQTTClientManager::diffTelemetry(const TelemetrySnapshot &a, const TelemetrySnapshot &b)
+{
+    uint8_t changed = 0;
+    if (a.running != b.running)
+        changed |= TELEMETRY_RUNNING;
+    if (a.moving != b.moving)
+        changed |= TELEMETRY_MOVING;
+    if (a.sequence != b.sequence)
+        changed |= TELEMETRY_SEQUENCE;
+    if (memcmp(a.position, b.position, sizeof(a.position)) != 0)
+        changed |= TELEMETRY_POSITION;
+    if (memcmp(a.target, b.target, sizeof(a.target)) != 0)
+        changed |= TELEMETRY_TARGET;
+    if (memcmp(a.estimate, b.estimate, sizeof(a.estimate)) != 0)
+        changed |= TELEMETRY_ESTIMATE;
+    if (memcmp(a.arrival, b.arrival, sizeof(a.arrival)) != 0)
+        changed |= TELEMETRY_ARRIVAL;
+    return changed;
+}
 
-        servoController.setPosition(targetPosition);
+// 只序列化 fields 中的字段，先写入定长缓冲区，再通过 beginPublish/write 一次发出。
+// 多通道时 position/target/estimate/arrival_ms 为数组，单通道时为数值；全量消息带 "full":true
+bool MQTTClientManager::writeTelemetry(const TelemetrySnapshot &snapshot, uint8_t fields)
+{
+    int count = servoController.getChannelCount();
 
-        if (cmd.restore == 1)
+    telemetryDoc.clear();
+    if (fields == TELEMETRY_ALL)
+        telemetryDoc["full"] = true;
+    if (fields & TELEMETRY_RUNNING)
+        telemetryDoc["running"] = snapshot.running;
+    if (fields & TELEMETRY_MOVING)
+        telemetryDoc["moving"] = snapshot.moving;
+    if (fields & TELEMETRY_SEQUENCE)
+        telemetryDoc["sequence"] = snapshot.sequence;
+    const int16_t *values[] = {snapshot.position, snapshot.target, snapshot.estimate, snapshot.arrival};
+    const char *keys[] = {"position", "target", "estimate", "arrival_ms"};
+    const uint8_t bits[] = {TELEMETRY_POSITION, TELEMETRY_TARGET, TELEMETRY_ESTIMATE, TELEMETRY_ARRIVAL};
+    for (int i = 0; i < 4; i++)
+    {
+        if (!(fields & bits[i]))
+            continue;
+        if (count <= 1)
         {
-            delay(ServoController::calculateMoveTime(lastPosition, targetPosition));
-            servoController.setPosition(lastPosition);
-            deviceStatus.servoPosition = lastPosition;
+            telemetryDoc[keys[i]] = values[i][0];
+            continue;
         }
-        else
+        JsonArray array = telemetryDoc[keys[i]].to<JsonArray>();
+        for (int ch = 0; ch < count; ch++)
         {
-            deviceStatus.servoPosition = targetPosition;
+            array.add(values[i][ch]);
         }
+    }
 
-        ledController.changeStatus(lastStatus);
+    char buffer[TELEMETRY_BUFFER_SIZE];
+    size_t length = serializeJson(telemetryDoc, buffer, sizeof(buffer));
+    if (length == 0 || length >= sizeof(buffer))
+    {
+        return false;
     }
+    if (!mqttClient.beginPublish(MQTT_TELEMETRY_TOPIC, length, false))
+    {
+        return false;
+    }
+    mqttClient.write((const uint8_t *)buffer, length);
+    return mqttClient.endPublish() == 1;
 }
 
-void MQTTClientManager::checkConnection()
+// 旧格式遥测，发布在命令主题上；设备收到自己发出的这条消息时因没有 command 字段直接忽略
+void MQTTClientManager::publishLegacyStatus(const TelemetrySnapshot &snapshot)
 {
-    if (deviceStatus.isWiFiConnected && !mqttClient.connected())
+    telemetryDoc.clear();
+    telemetryDoc["running"] = snapshot.running;
+    telemetryDoc["position"] = snapshot.position[0];
+
+    char buffer[64];
+    size_t length = serializeJson(telemetryDoc, buffer, sizeof(buffer));
+    if (length > 0 && length < sizeof(buffer))
     {
-        Serial.println("MQTT未连接，尝试重新连接");
-        setupMQTT();
+        mqttClient.publish(MQTT_TOPIC, (const uint8_t *)buffer, length);
     }
 }
 
+// 状态变化后尽快发布（两次发布至少间隔 TELEMETRY_MIN_INTERVAL_MS），只发送变化的字段；
+// 没有变化时每 TELEMETRY_HEARTBEAT_MS 发布一次全量心跳
 void MQTTClientManager::publishStatus()
 {
     if (!mqttClient.connected())
         return;
 
     unsigned long now = millis();
-    if (now - lastPublishTime > PUBLISH_INTERVAL)
-    {
-        lastPublishTime = now;
+    if (now - lastPublishTime < TELEMETRY_MIN_INTERVAL_MS)
+        return;
 
-        JsonDocument doc;
-        doc["running"] = deviceStatus.isServoRunning;
-        doc["position"] = deviceStatus.servoPosition;
+    TelemetrySnapshot current;
+    captureTelemetry(current);
+#if MQTT_LEGACY_TELEMETRY
+    if (now - lastLegacyPublishTime >= TELEMETRY_HEARTBEAT_MS)
+    {
+        lastLegacyPublishTime = now;
+        publishLegacyStatus(current);
+    }
+#endif
+    uint8_t changed = telemetryValid ? diffTelemetry(current, lastTelemetry) : (uint8_t)TELEMETRY_ALL;
+    if (now - lastPublishTime >= TELEMETRY_HEARTBEAT_MS)
+    {
+        changed = TELEMETRY_ALL;
+    }
+    if (!changed)
+        return;
 
-        String status;
-        serializeJson(doc, status);
-        mqttClient.publish(deviceStatus.mqttTopic.c_str(), status.c_str());
+    // 发布失败时保留旧快照，间隔过后重新比较
+    lastPublishTime = now;
+    if (writeTelemetry(current, changed))
+    {
+        lastTelemetry = current;
+        telemetryValid = true;
     }
 }
 
@@ -214,6 +547,7 @@ void MQTTClientManager::update()
     if (mqttClient.connected())
     {
         mqttClient.loop();
-        publishStatus();
     }
+    publishAcks();
+    publishStatus();
 }
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include <limits.h>
+#include "scheduler.h"
+
+TaskScheduler scheduler;
+
+// 用有符号差值比较时间，兼容 micros() 回绕
+static inline bool timeReached(unsigned long now, unsigned long at)
+{
+    return (long)(now - at) >= 0;
+}
+
+int TaskScheduler::addTask(const char *name, TaskCallback callback, unsigned long periodUs, TaskType type, uint8_t priority,
+                           unsigned long deadlineUs)
+{
+    if (_taskCount >= MAX_TASKS || !callback || periodUs == 0)
+    {
+        return -1;
+    }
+
+    Task &task = _tasks[_taskCount];
+    memset(&task, 0, sizeof(Task));
+    task.name = name;
+    task.callback = callback;
+    task.periodUs = periodUs;
+    task.deadlineUs = deadlineUs ? deadlineUs : periodUs;
+    task.releaseUs = micros();
+    task.type = type;
+    task.priority = priority;
+    return _taskCount++;
+}
+
+void TaskScheduler::run()
+{
+    unsigned long now = micros();
+
+    // 周期任务优先：到期的任务中选截止时间最早的
+    int id = pickPeriodic(now);
+    if (id < 0)
+    {
+        id = pickSlack(now);
+    }
+    if (id >= 0)
+    {
+        execute(id, now);
+    }
+}
+
+int TaskScheduler::pickPeriodic(unsigned long now) const
+{
+    int best = -1;
+    for (int i = 0; i < _taskCount; i++)
+    {
+        const Task &task = _tasks[i];
+        if (task.type != TASK_PERIODIC || !timeReached(now, task.releaseUs))
+        {
+            continue;
+        }
+        if (best < 0)
+        {
+            best = i;
+            continue;
+        }
+        long order = (long)((task.releaseUs + task.deadlineUs) - (_tasks[best].releaseUs + _tasks[best].deadlineUs));
+        if (order < 0 || (order == 0 && task.priority < _tasks[best].priority))
+        {
+            best = i;
+        }
+    }
+    return best;
+}
+
+int TaskScheduler::pickSlack(unsigned long now) const
+{
+    // 距离下一个周期任务释放还有多少空闲时间
+    long slack = LONG_MAX;
+    for (int i = 0; i < _taskCount; i++)
+    {
+        if (_tasks[i].type == TASK_PERIODIC)
+        {
+            slack = min(slack, (long)(_tasks[i].releaseUs - now));
+        }
+    }
+
+    int best = -1;
+    for (int i = 0; i < _taskCount; i++)
+    {
+        const Task &task = _tasks[i];
+        if (task.type != TASK_SLACK || !timeReached(now, task.releaseUs))
+        {
+            continue;
+        }
+        // 预计放得进空闲时间才运行；超过截止时间的任务不再等待，避免饿死
+        bool fits = (long)task.stats.avgRuntimeUs <= slack;
+        bool starving = timeReached(now, task.releaseUs + task.deadlineUs);
+        if (!fits && !starving)
+        {
+            continue;
+        }
+        if (best < 0 || task.priority < _tasks[best].priority ||
+            (task.priority == _tasks[best].priority && (long)(task.releaseUs - _tasks[best].releaseUs) < 0))
+        {
+            best = i;
+        }
+    }
+    return best;
+}
+
+void TaskScheduler::execute(int id, unsigned long now)
+{
+    Task &task = _tasks[id];
+    unsigned long lateness = now - task.releaseUs;
+
+    task.callback();
+
+    unsigned long runtime = micros() - now;
+    TaskStats &stats = task.stats;
+    stats.runs++;
+    stats.maxRuntimeUs = max(stats.maxRuntimeUs, runtime);
+    stats.maxLatenessUs = max(stats.maxLatenessUs, lateness);
+    stats.avgRuntimeUs = stats.runs == 1 ? runtime : stats.avgRuntimeUs + ((long)(runtime - stats.avgRuntimeUs) >> 3);
+    record(stats.runtimeHistogram, runtime);
+    record(stats.latenessHistogram, lateness);
+
+    if (task.type == TASK_PERIODIC)
+    {
+        // 按释放时间累加，保持固定相位；落后整周期时丢弃错过的节拍而不是连续补跑
+        task.releaseUs += task.periodUs;
+        if (timeReached(now, task.releaseUs))
+        {
+            unsigned long missed = (now - task.releaseUs) / task.periodUs + 1;
+            stats.overruns += missed;
+            task.releaseUs += missed * task.periodUs;
+        }
+    }
+    else
+    {
+        task.releaseUs = now + task.periodUs;
+    }
+}
+
+void TaskScheduler::record(uint32_t *histogram, unsigned long valueUs)
+{
+    int bucket = 0;
+    while (valueUs && bucket < SCHEDULER_HISTOGRAM_BUCKETS - 1)
+    {
+        valueUs >>= 1;
+        bucket++;
+    }
+    histogram[bucket]++;
+}
+
+void TaskScheduler::resetStats()
+{
+    for (int i = 0; i < _taskCount; i++)
+    {
+        memset(&_tasks[i].stats, 0, sizeof(TaskStats));
+    }
+}
@@ -2,56 +2,495 @@
 
 ServoController servoController;
 
-void ServoController::begin(int pin)
+static const uint32_t SERVO_GROUP_MASKS[] = SERVO_GROUPS;
+static const int32_t CALIBRATION_STEP = 18000 / (SERVO_CALIBRATION_POINTS - 1);
+static_assert(18000 % (SERVO_CALIBRATION_POINTS - 1) == 0, "修正表的点必须落在整 0.01 度上");
+
+void ServoController::begin(const int *pins, int count, const ServoCalibration *calibration, const ServoModel *models,
+                            const ServoCorrection *corrections)
+{
+    _channelCount = constrain(count, 0, SERVO_MAX_CHANNELS);
+    _runningMask = 0;
+    _movingMask = 0;
+    _outputMask = 0;
+    _keyframeMask = 0;
+    _sequenceMask = 0;
+    _respondingMask = 0;
+    _limits.maxVelocity = SERVO_MAX_VELOCITY;
+    _limits.maxAcceleration = SERVO_MAX_ACCELERATION;
+    _limits.maxJerk = SERVO_MAX_JERK;
+    _limits.profile = SERVO_MOTION_PROFILE;
+
+    for (int ch = 0; ch < _channelCount; ch++)
+    {
+        // 按允许的最大范围挂载，标定只影响脉宽表，运行中修改标定不必重新挂载
+        _servos[ch].attach(pins[ch], SERVO_PULSE_LIMIT_MIN_US, SERVO_PULSE_LIMIT_MAX_US);
+        ServoCalibration defaults = {SERVO_MIN_PULSE_US, SERVO_MAX_PULSE_US};
+        setCalibration(ch, calibration ? calibration[ch] : defaults, corrections ? &corrections[ch] : nullptr);
+        _pulse[ch] = 0;
+        _position[ch] = 0;
+        _target[ch] = 0;
+        _velocity[ch] = 0;
+        _minPosition[ch] = 0;
+        _maxPosition[ch] = 18000;
+        _output[ch] = 0;
+        _lastSwitchTime[ch] = 0;
+        _timelineHead[ch] = 0;
+        _timelineCount[ch] = 0;
+        _sequenceLength[ch] = 0;
+        MotionPlanner::plan(_limits, 0, 0, _segments[ch]);
+        _estimate[ch] = 0;
+        _estimateVelocity[ch] = 0;
+        _model[ch].speed = SERVO_MODEL_SPEED;
+        _model[ch].latencyMs = SERVO_MODEL_LATENCY_MS;
+        _model[ch].deadband = SERVO_MODEL_DEADBAND;
+        if (models)
+        {
+            setModel(ch, models[ch]);
+        }
+    }
+}
+
+uint32_t ServoController::resolveChannels(int channel, int group) const
+{
+    if (channel >= 0)
+    {
+        return validChannel(channel) ? 1UL << channel : 0;
+    }
+    if (group >= 0)
+    {
+        if (group >= (int)(sizeof(SERVO_GROUP_MASKS) / sizeof(SERVO_GROUP_MASKS[0])))
+        {
+            return 0;
+        }
+        return SERVO_GROUP_MASKS[group] & allChannels();
+    }
+    return _channelCount > 0 ? 1 : 0;
+}
+
+void ServoController::setRunning(uint32_t channels, bool running)
+{
+    channels &= allChannels();
+    if (running)
+    {
+        _runningMask |= channels;
+    }
+    else
+    {
+        _runningMask &= ~channels;
+    }
+}
+
+void ServoController::setChannelLimits(int channel, int minPosition, int maxPosition)
+{
+    if (!validChannel(channel) || minPosition > maxPosition)
+    {
+        return;
+    }
+    _minPosition[channel] = constrain(minPosition, 0, 180) * 100;
+    _maxPosition[channel] = constrain(maxPosition, 0, 180) * 100;
+}
+
+void ServoController::setCalibration(int channel, const ServoCalibration &calibration, const ServoCorrection *correction)
+{
+    if (!validChannel(channel))
+    {
+        return;
+    }
+    int32_t minUs = SERVO_MIN_PULSE_US;
+    int32_t maxUs = SERVO_MAX_PULSE_US;
+    if (calibration.minPulseUs < calibration.maxPulseUs)
+    {
+        minUs = calibration.minPulseUs;
+        maxUs = calibration.maxPulseUs;
+    }
+    for (int i = 0; i < SERVO_CALIBRATION_POINTS; i++)
+    {
+        int32_t pulse = minUs + (maxUs - minUs) * i / (SERVO_CALIBRATION_POINTS - 1);
+        if (correction)
+        {
+            pulse += correction->offsetUs[i];
+        }
+        _pulseTable[channel][i] = (uint16_t)constrain(pulse, SERVO_PULSE_LIMIT_MIN_US, SERVO_PULSE_LIMIT_MAX_US);
+    }
+    _outputMask &= ~(1UL << channel); // 下一次 update() 按新表重新输出
+}
+
+// 每次输出都调用，只用整数运算：定位所在区间后在相邻两点之间线性插值
+uint16_t ServoController::pulseFor(int channel, int32_t position) const
 {
-    _servo.attach(pin);
-    _isRunning = false;
-    _currentPosition = 0;
+    const uint16_t *table = _pulseTable[channel];
+    if (position <= 0)
+    {
+        return table[0];
+    }
+    int32_t index = position / CALIBRATION_STEP;
+    if (index >= SERVO_CALIBRATION_POINTS - 1)
+    {
+        return table[SERVO_CALIBRATION_POINTS - 1];
+    }
+    int32_t offset = position - index * CALIBRATION_STEP;
+    int32_t span = (int32_t)table[index + 1] - table[index];
+    return (uint16_t)(table[index] + (span * offset + CALIBRATION_STEP / 2) / CALIBRATION_STEP);
 }
 
-void ServoController::setRunning(bool running)
+void ServoController::startSegment(int channel, int32_t target, unsigned long now)
 {
-    _isRunning = running;
+    target = constrain(target, _minPosition[channel], _maxPosition[channel]);
+    MotionPlanner::plan(_limits, _position[channel], target, _segments[channel]);
+    _target[channel] = target;
+    _segmentStart[channel] = now;
+    _movingMask |= 1UL << channel;
 }
 
-void ServoController::setPosition(int position)
+// 从当前插值位置规划一段平滑运动到 position，由 update() 按节拍输出
+void ServoController::setPosition(int channel, int32_t position)
 {
     // 添加位置范围检查
-    if (position < 0 || position > 180)
+    if (!validChannel(channel) || position < 0 || position > 18000)
     {
         return;
     }
-    _currentPosition = position;
-    _servo.write(position);
-    Serial.print("舵机移动到位置 setPosition: ");
-    Serial.println(position);
+    startSegment(channel, position, millis());
+#if COMMAND_LOG
+    Serial.print("舵机");
+    Serial.print(channel);
+    Serial.print("移动到位置 setPosition: ");
+    Serial.println(position / 100.0);
+#endif
 }
 
-void ServoController::update()
+void ServoController::setModel(int channel, const ServoModel &model)
 {
-    if (!_isRunning)
+    if (!validChannel(channel) || model.speed == 0)
     {
         return;
     }
+    _model[channel] = model;
+}
 
-    unsigned long currentMillis = millis();
-    static unsigned long previousMillis = 0;
-    const long interval = 2000; // 每2秒切换一次位置
+unsigned long ServoController::calculateMoveTime(int fromPos, int toPos, int channel) const
+{
+    MotionSegment segment;
+    MotionPlanner::plan(_limits, (int32_t)fromPos * 100, (int32_t)toPos * 100, segment);
+    const ServoModel &model = getModel(channel);
+    if (abs(toPos - fromPos) * 100 <= model.deadband)
+    {
+        return 0;
+    }
+    unsigned long physicalMs = model.latencyMs + (unsigned long)abs(toPos - fromPos) * 1000 / model.speed;
+    return max((unsigned long)segment.durationMs, physicalMs);
+}
 
-    if (currentMillis - previousMillis >= interval)
+unsigned long ServoController::getArrivalMs(int channel) const
+{
+    if (!validChannel(channel))
+    {
+        return 0;
+    }
+    unsigned long now = millis();
+    uint32_t bit = 1UL << channel;
+    const ServoModel &model = _model[channel];
+    unsigned long commandMs = 0;
+    if (_movingMask & bit)
+    {
+        unsigned long elapsed = now - _segmentStart[channel];
+        commandMs = elapsed < _segments[channel].durationMs ? _segments[channel].durationMs - elapsed : 0;
+    }
+    int32_t distance = abs(_target[channel] - _estimate[channel]);
+    if (!(_respondingMask & bit) && distance <= model.deadband)
     {
-        previousMillis = currentMillis;
+        return commandMs;
+    }
+    unsigned long delayMs = model.latencyMs;
+    if (_respondingMask & bit)
+    {
+        delayMs = (long)(_responseStart[channel] - now) > 0 ? _responseStart[channel] - now : 0;
+    }
+    return max(commandMs, delayMs + (unsigned long)distance * 10 / model.speed);
+}
 
-        // 计算目标位置
-        int targetPosition = _currentPosition == 0 ? 180 : 0;
+// 立即开始向指定位置运动，丢弃尚未执行的关键帧
+void ServoController::moveTo(uint32_t channels, int32_t position)
+{
+    for (int ch = 0; ch < _channelCount; ch++)
+    {
+        if (channels & (1UL << ch))
+        {
+            stopSequence(1UL << ch);
+            clearTimeline(ch);
+            setPosition(ch, position);
+        }
+    }
+}
 
-        // 设置新位置
-        _servo.write(targetPosition);
-        _currentPosition = targetPosition;
+// 按下后复位：先到 position，停留 SERVO_RESTORE_HOLD_MS 后回到原来的位置
+// 连续调用时以时间线末尾的位置为原位，因此多次点按会依次执行并最终回到同一位置。
+// 任一通道排入即返回 true
+bool ServoController::moveAndRestore(uint32_t channels, int32_t position)
+{
+    bool queued = false;
+    for (int ch = 0; ch < _channelCount; ch++)
+    {
+        if (!(channels & (1UL << ch)) || _timelineCount[ch] + 2 > TIMELINE_CAPACITY)
+        {
+            continue;
+        }
+        stopSequence(1UL << ch);
+        int32_t restorePosition = finalTarget(ch);
+        queued |= queueKeyframe(ch, position, SERVO_RESTORE_HOLD_MS) && queueKeyframe(ch, restorePosition, 0);
+    }
+    return queued;
+}
 
-        // 不使用delay，改用millis()实现非阻塞延时
+bool ServoController::queueKeyframe(int channel, int32_t position, unsigned long holdMs)
+{
+    if (!validChannel(channel) || position < 0 || position > 18000 || _timelineCount[channel] >= TIMELINE_CAPACITY)
+    {
+        return false;
+    }
+    int tail = (_timelineHead[channel] + _timelineCount[channel]) % TIMELINE_CAPACITY;
+    _timeline[channel][tail].position = position;
+    _timeline[channel][tail].holdMs = holdMs;
+    _timelineCount[channel]++;
+    return true;
+}
 
-        Serial.print("舵机移动到位置: ");
-        Serial.println(targetPosition);
+void ServoController::clearTimeline(int channel)
+{
+    if (!validChannel(channel))
+    {
+        return;
     }
-}
\ No newline at end of file
+    _timelineHead[channel] = 0;
+    _timelineCount[channel] = 0;
+    _keyframeMask &= ~(1UL << channel);
+}
+
+bool ServoController::isTimelineBusy(int channel) const
+{
+    return validChannel(channel) && ((_keyframeMask & (1UL << channel)) || _timelineCount[channel] > 0);
+}
+
+// 时间线与当前运动全部完成后的最终位置
+int32_t ServoController::finalTarget(int channel) const
+{
+    if (_timelineCount[channel] == 0)
+    {
+        return _target[channel];
+    }
+    int last = (_timelineHead[channel] + _timelineCount[channel] - 1) % TIMELINE_CAPACITY;
+    return _timeline[channel][last].position;
+}
+
+void ServoController::updateTimeline(int channel, unsigned long now)
+{
+    uint32_t bit = 1UL << channel;
+    if ((_keyframeMask & bit) && (long)(now - _keyframeEnd[channel]) < 0)
+    {
+        return;
+    }
+    _keyframeMask &= ~bit;
+
+    if (_timelineCount[channel] == 0)
+    {
+        return;
+    }
+
+    ServoKeyframe &frame = _timeline[channel][_timelineHead[channel]];
+    _timelineHead[channel] = (_timelineHead[channel] + 1) % TIMELINE_CAPACITY;
+    _timelineCount[channel]--;
+
+    startSegment(channel, frame.position, now);
+    _keyframeEnd[channel] = now + _segments[channel].durationMs + frame.holdMs;
+    _keyframeMask |= bit;
+}
+
+// 把 frames 复制到各通道的序列缓冲区并从当前位置开始播放，loops 为 0 时一直循环
+bool ServoController::playSequence(uint32_t channels, const SequenceKeyframe *frames, int count, int loops)
+{
+    if (!isPlayableSequence(frames, count, loops))
+    {
+        return false;
+    }
+
+    unsigned long now = millis();
+    bool started = false;
+    for (int ch = 0; ch < _channelCount; ch++)
+    {
+        uint32_t bit = 1UL << ch;
+        if (!(channels & bit))
+        {
+            continue;
+        }
+        clearTimeline(ch);
+        _runningMask &= ~bit;
+        memcpy(_sequence[ch], frames, count * sizeof(SequenceKeyframe));
+        _sequenceLength[ch] = count;
+        _sequenceIndex[ch] = 0;
+        _sequenceLoops[ch] = loops > 0xFFFF ? 0xFFFF : loops;
+        _sequenceLoop[ch] = 0;
+        _sequenceMask |= bit;
+        startSequenceFrame(ch, _position[ch], now);
+        started = true;
+    }
+    return started;
+}
+
+bool ServoController::isPlayableSequence(const SequenceKeyframe *frames, int count, int loops)
+{
+    if (count <= 0 || count > SERVO_SEQUENCE_CAPACITY || loops < 0)
+    {
+        return false;
+    }
+    unsigned long totalMs = 0;
+    for (int i = 0; i < count; i++)
+    {
+        totalMs += frames[i].durationMs;
+    }
+    return totalMs > 0; // 零时长时无限循环无法推进时间，有限循环会在一个节拍内空转 loops 遍
+}
+
+void ServoController::startSequenceFrame(int channel, int32_t from, unsigned long start)
+{
+    const SequenceKeyframe &frame = _sequence[channel][_sequenceIndex[channel]];
+    int32_t target = constrain((int32_t)frame.position, _minPosition[channel], _maxPosition[channel]);
+    MotionPlanner::planTimed(from, target, frame.durationMs, (MotionEasing)frame.easing, _segments[channel]);
+    _target[channel] = target;
+    _segmentStart[channel] = start;
+    _movingMask |= 1UL << channel;
+}
+
+// 帧边界按理论时刻（上一帧开始 + 时长）推进，而不是按检测到的节拍时刻，
+// 因此节拍抖动不会累积到后续帧；一个节拍内跨过多帧时逐帧补上
+void ServoController::updateSequence(int channel, unsigned long now)
+{
+    uint32_t bit = 1UL << channel;
+    while ((_sequenceMask & bit) && now - _segmentStart[channel] >= _segments[channel].durationMs)
+    {
+        unsigned long boundary = _segmentStart[channel] + _segments[channel].durationMs;
+        if (++_sequenceIndex[channel] >= _sequenceLength[channel])
+        {
+            _sequenceIndex[channel] = 0;
+            if (_sequenceLoops[channel] && ++_sequenceLoop[channel] >= _sequenceLoops[channel])
+            {
+                _sequenceMask &= ~bit;
+                break;
+            }
+        }
+        startSequenceFrame(channel, _target[channel], boundary);
+    }
+}
+
+void ServoController::update()
+{
+    unsigned long now = millis();
+    unsigned long dt = now - _lastTickTime;
+    _lastTickTime = now;
+
+    for (int ch = 0; ch < _channelCount; ch++)
+    {
+        uint32_t bit = 1UL << ch;
+
+        if (_sequenceMask & bit)
+        {
+            updateSequence(ch, now);
+        }
+        else if ((_keyframeMask & bit) || _timelineCount[ch])
+        {
+            updateTimeline(ch, now);
+        }
+        else if ((_runningMask & bit) && !(_movingMask & bit) && now - _lastSwitchTime[ch] >= 2000)
+        {
+            // 连续运行模式：每2秒在两端之间切换一次
+            _lastSwitchTime[ch] = now;
+            int32_t target = _output[ch] == 0 ? 18000 : 0;
+            startSegment(ch, target, now);
+#if COMMAND_LOG
+            Serial.print("舵机");
+            Serial.print(ch);
+            Serial.print("移动到位置: ");
+            Serial.println(target / 100);
+#endif
+        }
+
+        if (_movingMask & bit)
+        {
+            sampleSegment(ch, now, dt);
+        }
+        else
+        {
+            _velocity[ch] = 0;
+            if (_pulse[ch] && !(_outputMask & bit))
+            {
+                writeOutput(ch); // 静止的通道标定改变后按新表重新输出
+            }
+        }
+        updateEstimate(ch, now, dt);
+    }
+}
+
+void ServoController::sampleSegment(int channel, unsigned long now, unsigned long dt)
+{
+    uint32_t bit = 1UL << channel;
+    unsigned long elapsed = now - _segmentStart[channel];
+    int32_t position = MotionPlanner::sample(_segments[channel], elapsed);
+    _velocity[channel] = dt ? (position - _position[channel]) * 1000 / (int32_t)dt : 0;
+    _position[channel] = position;
+    if (elapsed >= _segments[channel].durationMs)
+    {
+        _movingMask &= ~bit;
+    }
+
+    _output[channel] = position;
+    writeOutput(channel);
+}
+
+// 位置变化小于脉宽分辨率时不重复写入
+void ServoController::writeOutput(int channel)
+{
+    uint32_t bit = 1UL << channel;
+    uint16_t pulse = pulseFor(channel, _output[channel]);
+    if (pulse != _pulse[channel] || !(_outputMask & bit))
+    {
+        _outputMask |= bit;
+        _pulse[channel] = pulse;
+        _servos[channel].writeMicroseconds(pulse);
+    }
+}
+
+// 舵盘追赶最近一次输出的脉宽。静止时偏差超过死区才开始响应，响应前有 latencyMs 的延迟；
+// 指令仍在变化时保持响应状态，跟随轨迹时不会每个节拍重复计入延迟
+void ServoController::updateEstimate(int channel, unsigned long now, unsigned long dt)
+{
+    uint32_t bit = 1UL << channel;
+    const ServoModel &model = _model[channel];
+    int32_t command = _output[channel];
+    int32_t error = command - _estimate[channel];
+    _estimateVelocity[channel] = 0;
+
+    if (!(_respondingMask & bit))
+    {
+        if (abs(error) <= model.deadband)
+        {
+            return;
+        }
+        _respondingMask |= bit;
+        _responseStart[channel] = now + model.latencyMs;
+    }
+    long active = (long)(now - _responseStart[channel]);
+    if (active <= 0)
+    {
+        return;
+    }
+
+    // 度/秒 × 毫秒 = 0.001 度
+    int32_t step = (int32_t)(model.speed * min((unsigned long)active, dt) / 10);
+    int32_t moved = error > 0 ? min(error, step) : max(error, -step);
+    _estimate[channel] += moved;
+    _estimateVelocity[channel] = dt ? moved * 1000 / (int32_t)dt : 0;
+    if (_estimate[channel] == command && !(_movingMask & bit))
+    {
+        _respondingMask &= ~bit;
+    }
+}
@@ -0,0 +1,48 @@
+#include "servo_model.h"
+
+// 只在标定时执行一次，可以使用浮点
+bool ServoModelFitter::fit(const ServoModelSample *samples, int count, ServoModel &model)
+{
+    float sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+    int moved = 0;
+    int32_t minMoved = INT32_MAX;
+    int32_t maxStalled = -1;
+    for (int i = 0; i < count; i++)
+    {
+        int32_t distance = abs(samples[i].distance);
+        if (samples[i].durationMs == 0)
+        {
+            maxStalled = max(maxStalled, distance);
+            continue;
+        }
+        float x = distance / 100.0f;
+        float y = samples[i].durationMs;
+        sumX += x;
+        sumY += y;
+        sumXX += x * x;
+        sumXY += x * y;
+        minMoved = min(minMoved, distance);
+        moved++;
+    }
+
+    float denominator = moved * sumXX - sumX * sumX;
+    if (moved < 2 || denominator <= 0)
+    {
+        return false;
+    }
+    float msPerDegree = (moved * sumXY - sumX * sumY) / denominator;
+    float latencyMs = (sumY - msPerDegree * sumX) / moved;
+    if (msPerDegree <= 0)
+    {
+        return false;
+    }
+
+    model.speed = (uint16_t)constrain(1000.0f / msPerDegree + 0.5f, 1.0f, 65535.0f);
+    model.latencyMs = (uint16_t)constrain(latencyMs + 0.5f, 0.0f, 65535.0f);
+    if (maxStalled >= 0)
+    {
+        // 没有动作的阶跃不能大于有动作的阶跃，测量矛盾时以有动作的为准
+        model.deadband = (uint16_t)min(maxStalled, minMoved - 1);
+    }
+    return true;
+}
@@ -0,0 +1,328 @@
+#include "servo_task.h"
+#include "command_router.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+ServoTask servoTask;
+
+void ServoTask::begin()
+{
+    publishSnapshot(); // 任务开始之前网络任务读到的是初始状态
+    if (!isDualCore())
+    {
+        return;
+    }
+    xTaskCreatePinnedToCore(run, "servo", SERVO_TASK_STACK, this, SERVO_TASK_PRIORITY, nullptr, SERVO_TASK_CORE);
+}
+
+// 按绝对时间延时，节拍不会因单次执行时间而漂移
+void ServoTask::run(void *parameter)
+{
+    ServoTask *self = (ServoTask *)parameter;
+    TickType_t lastWake = xTaskGetTickCount();
+    for (;;)
+    {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(SERVO_TICK_INTERVAL_US / 1000));
+        self->tick();
+    }
+}
+
+// 舵机任务的计数只有一个写入方，不需要原子读改写，只要网络任务读到的值不被撕裂
+static void increment(std::atomic<unsigned long> &counter)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+template <typename T>
+static uint16_t traceIdOf(const T &item)
+{
+#if ENABLE_TRACE
+    return item.traceId;
+#else
+    return 0;
+#endif
+}
+
+bool ServoTask::submit(const ServoCommand &command)
+{
+    if (command.op == SERVO_OP_SEQUENCE && !ServoController::isPlayableSequence(command.frames, command.frameCount, command.loops))
+    {
+        return false;
+    }
+
+    ServoCommand ordered = command;
+    ordered.order = _submitted + 1;
+    if (command.op == SERVO_OP_MOVE)
+    {
+        postTargets(ordered);
+    }
+    else if (!isDualCore())
+    {
+        // 单核时直接执行，之前写入邮箱的目标先执行
+        collectTargets();
+        applyTargets(command.channels, ordered.order);
+        apply(ordered);
+    }
+    else if (!_queue.push(ordered))
+    {
+        _dropped++;
+        return false;
+    }
+    _submitted = ordered.order;
+    _published.store(_submitted, std::memory_order_release);
+    return true;
+}
+
+bool ServoTask::pollAck(CommandAck &ack)
+{
+    return _acks.pop(ack) || _superseded.pop(ack);
+}
+
+// 写入各通道的邮箱。发布时上一个目标若仍未被取走，说明它在执行前已被本次目标覆盖
+void ServoTask::postTargets(const ServoCommand &command)
+{
+    bool first = true;
+    for (int ch = 0; ch < SERVO_MAX_CHANNELS; ch++)
+    {
+        if (!(command.channels & (1UL << ch)))
+        {
+            continue;
+        }
+        TripleBuffer<ServoTarget> &slot = _targets[ch];
+        ServoTarget &target = slot.back();
+        target.order = command.order;
+        target.position = command.position;
+        target.ack = command.ack;
+        if (!first)
+        {
+            target.ack.route = 0;
+        }
+#if ENABLE_TRACE
+        target.traceId = first ? command.traceId : 0;
+#endif
+        first = false;
+        _targetsPosted++;
+
+        if (slot.publish())
+        {
+            _coalesced++;
+            if (slot.back().ack.route)
+            {
+                CommandAck ack = slot.back().ack;
+                ack.result = COMMAND_SUPERSEDED;
+                ack.appliedUs = micros();
+                if (!_superseded.push(ack))
+                {
+                    _supersededDropped++;
+                }
+            }
+        }
+    }
+}
+
+// 取出邮箱中的新目标。上一节拍留下的目标若又被更新，旧的同样算作被覆盖
+void ServoTask::collectTargets()
+{
+    for (int ch = 0; ch < SERVO_MAX_CHANNELS; ch++)
+    {
+        if (!_targets[ch].acquire())
+        {
+            continue;
+        }
+        if (_pendingMask & (1UL << ch))
+        {
+            increment(_coalescedInTick);
+            supersede(_pending[ch].ack);
+        }
+        _pending[ch] = _targets[ch].front();
+        _pendingMask |= 1UL << ch;
+    }
+}
+
+// 执行 channels 中提交序号早于 before 的目标
+void ServoTask::applyTargets(uint32_t channels, uint32_t before)
+{
+    uint32_t mask = _pendingMask & channels;
+    for (int ch = 0; mask && ch < SERVO_MAX_CHANNELS; ch++)
+    {
+        uint32_t bit = 1UL << ch;
+        if (!(mask & bit) || (int32_t)(_pending[ch].order - before) >= 0)
+        {
+            continue;
+        }
+        _pendingMask &= ~bit;
+        increment(_commands);
+        servoController.setRunning(bit, false);
+        servoController.moveTo(bit, _pending[ch].position);
+        complete(_pending[ch].ack, traceIdOf(_pending[ch]));
+    }
+}
+
+void ServoTask::supersede(const CommandAck &ack)
+{
+    if (!ack.route)
+    {
+        return;
+    }
+    CommandAck superseded = ack;
+    superseded.result = COMMAND_SUPERSEDED;
+    superseded.appliedUs = micros();
+    if (!_acks.push(superseded))
+    {
+        increment(_acksDropped);
+    }
+}
+
+// 节拍内的执行顺序：先按提交序号交错执行队列中的命令与邮箱目标，只处理节拍开始时已完整提交的部分；
+// 序号更大的目标留到下一节拍，保证不会越过尚未出现在队列中的更早命令
+void ServoTask::tick()
+{
+    unsigned long now = micros();
+    if (_ticks.load(std::memory_order_relaxed) > 0)
+    {
+        long jitter = (long)(now - _lastTickUs) - SERVO_TICK_INTERVAL_US;
+        unsigned long magnitude = jitter < 0 ? -jitter : jitter;
+        if (magnitude > _maxJitterUs.load(std::memory_order_relaxed))
+        {
+            _maxJitterUs.store(magnitude, std::memory_order_relaxed);
+        }
+    }
+    _lastTickUs = now;
+    increment(_ticks);
+
+    uint32_t limit = _published.load(std::memory_order_acquire);
+    collectTargets();
+    const ServoCommand *next;
+    while ((next = _queue.front()) && (int32_t)(next->order - limit) <= 0)
+    {
+        applyTargets(next->channels, next->order);
+        apply(*next);
+        _queue.drop();
+    }
+    applyTargets(0xFFFFFFFF, limit + 1);
+    servoController.update();
+    publishSnapshot();
+
+#if ENABLE_TRACE
+    for (int i = 0; i < _tracePendingCount; i++)
+    {
+        tracer.servoWritten(_tracePending[i]);
+    }
+    _tracePendingCount = 0;
+#endif
+}
+
+// 命令在舵机上下文中执行
+void ServoTask::apply(const ServoCommand &command)
+{
+    increment(_commands);
+    switch (command.op)
+    {
+    case SERVO_OP_START:
+        servoController.setRunning(command.channels, true);
+        break;
+    case SERVO_OP_STOP:
+        servoController.setRunning(command.channels, false);
+        servoController.stopSequence(command.channels);
+        break;
+    case SERVO_OP_MOVE:
+        servoController.setRunning(command.channels, false);
+        servoController.moveTo(command.channels, command.position);
+        break;
+    case SERVO_OP_MOVE_RESTORE:
+        servoController.setRunning(command.channels, false);
+        servoController.moveAndRestore(command.channels, command.position);
+        break;
+    case SERVO_OP_SEQUENCE:
+        servoController.playSequence(command.channels, command.frames, command.frameCount, command.loops);
+        break;
+    case SERVO_OP_CALIBRATE:
+        for (int ch = 0; ch < SERVO_MAX_CHANNELS; ch++)
+        {
+            if (!(command.channels & (1UL << ch)))
+            {
+                continue;
+            }
+            if (command.calibrate & CALIBRATE_MODEL)
+            {
+                servoController.setModel(ch, command.model);
+            }
+            if (command.calibrate & CALIBRATE_PULSE)
+            {
+                servoController.setCalibration(ch, command.calibration, &command.correction);
+            }
+        }
+        break;
+    }
+    complete(command.ack, traceIdOf(command));
+}
+
+void ServoTask::complete(const CommandAck &ack, uint16_t traceId)
+{
+    if (ack.route)
+    {
+        CommandAck done = ack;
+        done.result = COMMAND_OK;
+        done.appliedUs = micros();
+        if (!_acks.push(done))
+        {
+            increment(_acksDropped);
+        }
+    }
+#if ENABLE_TRACE
+    if (traceId && _tracePendingCount < SERVO_COMMAND_QUEUE_DEPTH + SERVO_MAX_CHANNELS)
+    {
+        _tracePending[_tracePendingCount++] = traceId;
+    }
+#endif
+}
+
+void ServoTask::publishSnapshot()
+{
+    ServoSnapshot &snapshot = _snapshots.back();
+    int count = servoController.getChannelCount();
+    snapshot.channelCount = (uint8_t)count;
+    snapshot.runningMask = servoController.getRunningMask();
+    snapshot.movingMask = 0;
+    snapshot.sequenceMask = 0;
+    for (int ch = 0; ch < count; ch++)
+    {
+        ServoChannelStatus &status = snapshot.channels[ch];
+        status.position = servoController.getCurrentPosition(ch);
+        status.target = servoController.getTargetPosition(ch);
+        status.velocity = servoController.getVelocity(ch);
+        status.estimate = servoController.getEstimatedPosition(ch);
+        status.estimateVelocity = servoController.getEstimatedVelocity(ch);
+        status.pulseUs = servoController.getPulseUs(ch);
+        status.arrivalMs = servoController.getArrivalMs(ch);
+        if (servoController.isMoving(ch))
+        {
+            snapshot.movingMask |= 1UL << ch;
+        }
+        if (servoController.isSequencePlaying(ch))
+        {
+            snapshot.sequenceMask |= 1UL << ch;
+        }
+    }
+    _snapshots.publish();
+}
+
+const ServoSnapshot &ServoTask::snapshot()
+{
+    _snapshots.acquire();
+    return _snapshots.front();
+}
+
+ServoTaskStats ServoTask::getStats() const
+{
+    ServoTaskStats stats;
+    stats.ticks = _ticks.load(std::memory_order_relaxed);
+    stats.commands = _commands.load(std::memory_order_relaxed);
+    stats.dropped = _dropped;
+    stats.acksDropped = _acksDropped.load(std::memory_order_relaxed) + _supersededDropped;
+    stats.maxJitterUs = _maxJitterUs.load(std::memory_order_relaxed);
+    stats.targets = _targetsPosted;
+    stats.coalesced = _coalesced;
+    stats.coalescedInTick = _coalescedInTick.load(std::memory_order_relaxed);
+    return stats;
+}
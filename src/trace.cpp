@@ -0,0 +1,126 @@
+#include "trace.h"
+
+#if ENABLE_TRACE
+
+Tracer tracer;
+
+static const uint32_t BUCKET_BOUNDS_US[TRACE_BUCKET_COUNT] = {
+    10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 100000};
+
+static const char *const STAGE_NAMES[TRACE_STAGE_COUNT] = {
+    "receive",
+    "parse",
+    "auth",
+    "dispatch",
+    "servo_write",
+};
+
+static const char *const SOURCE_NAMES[TRACE_SOURCE_COUNT] = {
+    "mqtt",
+    "mqtt_binary",
+    "http",
+    "ws",
+};
+
+uint32_t Tracer::bucketUpperBoundUs(int bucket)
+{
+    return bucket < TRACE_BUCKET_COUNT ? BUCKET_BOUNDS_US[bucket] : 0xFFFFFFFF;
+}
+
+const char *Tracer::stageName(TraceStage stage)
+{
+    return stage < TRACE_STAGE_COUNT ? STAGE_NAMES[stage] : "";
+}
+
+const char *Tracer::sourceName(TraceSource source)
+{
+    return source < TRACE_SOURCE_COUNT ? SOURCE_NAMES[source] : "";
+}
+
+void Tracer::begin(TraceSource source)
+{
+    begin(source, now());
+}
+
+void Tracer::begin(TraceSource source, uint32_t receivedUs)
+{
+    collect();
+    _commands[source]++;
+    _currentId = nextId(_currentId);
+    TraceRecord &current = slot(_currentId);
+    current.id = _currentId;
+    current.source = source;
+    current.stages = 1 << TRACE_RECEIVE;
+    current.timeUs[TRACE_RECEIVE] = receivedUs;
+}
+
+void Tracer::stage(TraceStage stage)
+{
+    if (_currentId)
+    {
+        record(slot(_currentId), stage, now());
+    }
+}
+
+// 舵机任务中调用，只写队列
+void Tracer::servoWritten(uint16_t id)
+{
+    ServoStamp stamp = {id, now()};
+    if (!_servoStamps.push(stamp))
+    {
+        _droppedStamps++;
+    }
+}
+
+void Tracer::collect()
+{
+    ServoStamp stamp;
+    while (_servoStamps.pop(stamp))
+    {
+        TraceRecord &target = slot(stamp.id);
+        if (target.id == stamp.id)
+        {
+            record(target, TRACE_SERVO_WRITE, stamp.timeUs);
+        }
+    }
+}
+
+// 每个阶段只记录第一次到达，延迟计入对应阶段的直方图
+void Tracer::record(TraceRecord &record, TraceStage stage, uint32_t timeUs)
+{
+    if (record.stages & (1 << stage))
+    {
+        return;
+    }
+    record.stages |= 1 << stage;
+    record.timeUs[stage] = timeUs;
+
+    uint32_t latencyUs = timeUs - record.timeUs[TRACE_RECEIVE];
+    TraceHistogram &histogram = _histograms[stage];
+    int bucket = 0;
+    while (bucket < TRACE_BUCKET_COUNT && latencyUs > BUCKET_BOUNDS_US[bucket])
+    {
+        bucket++;
+    }
+    histogram.buckets[bucket]++;
+    histogram.count++;
+    histogram.sumUs += latencyUs;
+}
+
+const TraceRecord *Tracer::getRecord(int age) const
+{
+    if (!_currentId || age >= TRACE_BUFFER_SIZE)
+    {
+        return nullptr;
+    }
+    // 编号跳过 0，往回数时同样跳过
+    uint16_t id = _currentId;
+    for (int i = 0; i < age; i++)
+    {
+        id = id == 1 ? 0xFFFF : id - 1;
+    }
+    const TraceRecord &record = _records[id & (TRACE_BUFFER_SIZE - 1)];
+    return record.id == id ? &record : nullptr;
+}
+
+#endif
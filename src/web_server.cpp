@@ -1,6 +1,17 @@
 #include "web_server.h"
 #include "led_control.h"
 #include "servo_control.h"
+#include "servo_task.h"
+#include "command_router.h"
+#include "wifi_manager.h"
+#include "scheduler.h"
+#include "boot_profiler.h"
+#include "trace.h"
+#include "web_assets.h"
+#include "mqtt_client.h"
+#include "config_store.h"
+#include "servo_model.h"
+#include <stdarg.h>
 
 String Response::toJson()
 {
@@ -13,135 +24,12 @@ String Response::toJson()
     return json;
 }
 
-extern WebServer server;
+extern HttpServer server;
 extern DeviceStatus deviceStatus;
 extern WiFiCredentials credentials;
 
 WebServerManager webServerManager;
 
-// HTML页面
-const char INDEX_HTML[] PROGMEM = R"rawliteral(
-<!DOCTYPE html>
-<html>
-<head>
-    <meta charset="UTF-8">
-    <title>ESP32舵机控制</title>
-    <meta name="viewport" content="width=device-width, initial-scale=1">
-    <style>
-        body { font-family: Arial; margin: 0; padding: 20px; }
-        .container { max-width: 600px; margin: 0 auto; }
-        .card { background: #fff; padding: 20px; border-radius: 8px; box-shadow: 0 2px 4px rgba(0,0,0,0.1); margin-bottom: 20px; }
-        .btn { background: #007bff; color: white; border: none; padding: 10px 20px; border-radius: 4px; cursor: pointer; }
-        .btn:disabled { background: #ccc; }
-        input[type="text"], input[type="password"] { width: 100%; padding: 8px; margin: 5px 0; border: 1px solid #ddd; border-radius: 4px; }
-        .status { margin-top: 10px; }
-    </style>
-</head>
-<body>
-    <div class="container">
-        <div class="card">
-            <h2>设备状态</h2>
-            <div id="status" class="status">
-                <p>WiFi: <span id="wifiStatus">%s</span></p>
-                <p>IP: <span id="ipAddress">%s</span></p>
-                <p>舵机位置: <span id="servoPos">%d°</span></p>
-                <p>运行状态: <span id="runningStatus">%s</span></p>
-            </div>
-        </div>
-
-        <div class="card">
-            <h2>WiFi设置</h2>
-            <form id="wifiForm">
-                <input type="text" id="ssid" placeholder="WiFi名称" required><br>
-                <input type="password" id="password" placeholder="WiFi密码" required><br>
-                <button type="submit" class="btn">保存设置</button>
-            </form>
-        </div>
-
-        <div class="card">
-            <h2>舵机控制</h2>
-            <button id="startBtn" class="btn">开始运行</button>
-            <button id="stopBtn" class="btn">停止运行</button>
-            <input type="range" id="posSlider" min="0" max="180" value="90">
-            <span id="posValue">90°</span>
-        </div>
-    </div>
-
-    <script>
-        // 获取状态
-        function updateStatus() {
-            fetch('/status')
-                .then(response => response.json())
-                .then(res => {
-                    const {data} = res;
-                    document.getElementById('wifiStatus').textContent = data.wifi_ssid || '未连接';
-                    document.getElementById('ipAddress').textContent = data.wifi_ip || '-';
-                    document.getElementById('servoPos').textContent = data.servo_position + '°';
-                    document.getElementById('runningStatus').textContent = data.is_running ? '运行中' : '已停止';
-                });
-        }
-
-        // WiFi设置
-        document.getElementById('wifiForm').onsubmit = function(e) {
-            e.preventDefault();
-            const ssid = document.getElementById('ssid').value;
-            const password = document.getElementById('password').value;
-            
-            fetch('/setwifi', {
-                method: 'POST',
-                headers: {'Content-Type': 'application/json'},
-                body: JSON.stringify({ssid, password})
-            })
-            .then(response => response.json())
-            .then(data => {
-                alert(data.message);
-                if(data.success) {
-                    setTimeout(updateStatus, 5000);
-                }
-            });
-        };
-
-        // 舵机控制
-        document.getElementById('startBtn').onclick = () => {
-            fetch('/control', {
-                method: 'POST',
-                headers: {'Content-Type': 'application/json'},
-                body: JSON.stringify({command: 'start'})
-            });
-        };
-
-        document.getElementById('stopBtn').onclick = () => {
-            fetch('/control', {
-                method: 'POST',
-                headers: {'Content-Type': 'application/json'},
-                body: JSON.stringify({command: 'stop'})
-            });
-        };
-
-        const slider = document.getElementById('posSlider');
-        const posValue = document.getElementById('posValue');
-        slider.oninput = function() {
-            posValue.textContent = this.value + '°';
-        };
-        slider.onchange = function() {
-            fetch('/control', {
-                method: 'POST',
-                headers: {'Content-Type': 'application/json'},
-                body: JSON.stringify({
-                    command: 'position',
-                    position: parseInt(this.value)
-                })
-            });
-        };
-
-        // 定期更新状态
-        setInterval(updateStatus, 1000);
-        updateStatus();
-    </script>
-</body>
-</html>
-)rawliteral";
-
 void WebServerManager::begin()
 {
     setupRoutes();
@@ -151,38 +39,59 @@ void WebServerManager::begin()
 void WebServerManager::handleClient()
 {
     server.handleClient();
+
+    if (restartPending && millis() - restartRequestedAt >= RESTART_DELAY)
+    {
+        ESP.restart();
+    }
+}
+
+void WebServerManager::scheduleRestart()
+{
+    restartPending = true;
+    restartRequestedAt = millis();
 }
 
 void WebServerManager::setupRoutes()
 {
-    server.on("/", HTTP_GET, [this]()
+    server.on("/", HTTP_METHOD_GET, [this]()
               { handleRoot(); });
-    server.on("/status", HTTP_GET, [this]()
+    server.on("/status", HTTP_METHOD_GET, [this]()
               { handleStatus(); });
-    server.on("/setwifi", HTTP_POST, [this]()
+    server.on("/setwifi", HTTP_METHOD_POST, [this]()
               { handleSetWiFi(); });
-    server.on("/resetwifi", HTTP_POST, [this]()
+    server.on("/resetwifi", HTTP_METHOD_POST, [this]()
               { handleResetWiFi(); });
-
-    server.on("/control", HTTP_POST, [this]()
+    server.on("/scheduler", HTTP_METHOD_GET, [this]()
+              { handleScheduler(); });
+    server.on("/metrics", HTTP_METHOD_GET, [this]()
+              { handleMetrics(); });
+#if ENABLE_TRACE
+    server.on("/trace", HTTP_METHOD_GET, [this]()
+              { handleTrace(); });
+#endif
+
+    server.on("/control", HTTP_METHOD_POST, [this]()
               { handleControl(); });
+    server.on("/calibrate", HTTP_METHOD_POST, [this]()
+              { handleCalibrate(); });
     server.onNotFound([this]()
                       { handleNotFound(); });
 }
 
+// 页面在构建时压缩为 gzip 数组（见 scripts/build_web.py），直接从 flash 发送；
+// 动态数据由页面加载后请求 /status 和 WebSocket 获取
 void WebServerManager::handleRoot()
 {
-    String html = String(INDEX_HTML);
-    const char *runningStatus = deviceStatus.isServoRunning ? "运行中" : "已停止";
-    String ipAddress = WiFi.status() == WL_CONNECTED ? WiFi.localIP().toString() : "-";
-    String wifiName = deviceStatus.wifiSSID[0] != '\0' ? deviceStatus.wifiSSID : "未连接";
-
-    html.replace("%s", wifiName);
-    html.replace("%s", ipAddress);
-    html.replace("%d", String(deviceStatus.servoPosition));
-    html.replace("%s", runningStatus);
-
-    server.send(200, "text/html", html);
+    server.sendHeader("ETag", INDEX_HTML_ETAG);
+    server.sendHeader("Cache-Control", "no-cache");
+    if (server.header("If-None-Match") == INDEX_HTML_ETAG)
+    {
+        server.send(304);
+        return;
+    }
+    server.sendHeader("Content-Encoding", "gzip");
+    server.send_P(200, "text/html", (PGM_P)INDEX_HTML_GZ, INDEX_HTML_GZ_LEN);
 }
 
 void WebServerManager::handleStatus()
@@ -193,8 +102,27 @@ void WebServerManager::handleStatus()
     JsonDocument &data = response.data;
     data["wifi_ssid"] = deviceStatus.wifiSSID[0] != '\0' ? deviceStatus.wifiSSID : "未连接";
     data["wifi_ip"] = WiFi.status() == WL_CONNECTED ? WiFi.localIP().toString() : "-";
-    data["is_running"] = deviceStatus.isServoRunning;
-    data["servo_position"] = deviceStatus.servoPosition;
+    data["wifi_networks"] = wifiManager.getNetworkCount();
+    data["wifi_connect_ms"] = wifiManager.getLastConnectDuration();
+    const ServoSnapshot &servo = servoTask.snapshot();
+    data["is_running"] = servo.runningMask != 0;
+    data["servo_position"] = servo.channels[0].estimate;
+    data["servo_speed"] = servo.channels[0].estimateVelocity;
+
+    JsonArray channels = data["channels"].to<JsonArray>();
+    for (int ch = 0; ch < servo.channelCount; ch++)
+    {
+        const ServoChannelStatus &status = servo.channels[ch];
+        JsonObject channel = channels.add<JsonObject>();
+        channel["position"] = status.position;
+        channel["target"] = status.target;
+        channel["velocity"] = status.velocity;
+        channel["estimated"] = status.estimate;
+        channel["estimated_velocity"] = status.estimateVelocity;
+        channel["arrival_ms"] = status.arrivalMs;
+        channel["pulse_us"] = status.pulseUs;
+        channel["running"] = (servo.runningMask & (1UL << ch)) != 0;
+    }
 
     sendResponse(response);
 }
@@ -227,10 +155,11 @@ void WebServerManager::handleSetWiFi()
     }
 
     // 保存WiFi凭证
-    strncpy(credentials.ssid, ssid, sizeof(credentials.ssid) - 1);
-    strncpy(credentials.password, password, sizeof(credentials.password) - 1);
-    EEPROM.put(0, credentials);
-    EEPROM.commit();
+    if (!wifiManager.saveCredentials(ssid, password))
+    {
+        server.send(500, "application/json", "{\"success\":false,\"message\":\"保存失败\"}");
+        return;
+    }
 
     Response response;
     response.success = true;
@@ -238,79 +167,384 @@ void WebServerManager::handleSetWiFi()
     sendResponse(response);
 
     // 延迟重启
-    delay(1000);
-    ESP.restart();
+    scheduleRestart();
 }
 
 void WebServerManager::handleResetWiFi()
 {
-    memset(&credentials, 0, sizeof(WiFiCredentials));
-    EEPROM.put(0, credentials);
-    EEPROM.commit();
+    wifiManager.clearCredentials();
 
     Response response;
     response.success = true;
     response.message = "WiFi设置已重置，设备将重启";
     sendResponse(response);
 
-    delay(1000);
-    ESP.restart();
+    scheduleRestart();
 }
 
-void WebServerManager::handleControl()
+void WebServerManager::handleScheduler()
+{
+    Response response;
+    response.success = true;
+
+    JsonArray tasks = response.data["tasks"].to<JsonArray>();
+    for (int i = 0; i < scheduler.getTaskCount(); i++)
+    {
+        const TaskStats *stats = scheduler.getStats(i);
+        JsonObject task = tasks.add<JsonObject>();
+        task["name"] = scheduler.getTaskName(i);
+        task["runs"] = stats->runs;
+        task["overruns"] = stats->overruns;
+        task["avg_runtime_us"] = stats->avgRuntimeUs;
+        task["max_runtime_us"] = stats->maxRuntimeUs;
+        task["max_lateness_us"] = stats->maxLatenessUs;
+
+        // 直方图以 [桶上界us, 次数] 输出，省略空桶
+        JsonArray runtime = task["runtime_histogram"].to<JsonArray>();
+        JsonArray lateness = task["lateness_histogram"].to<JsonArray>();
+        for (int b = 0; b < SCHEDULER_HISTOGRAM_BUCKETS; b++)
+        {
+            if (stats->runtimeHistogram[b])
+            {
+                JsonArray bucket = runtime.add<JsonArray>();
+                bucket.add(TaskScheduler::bucketUpperBoundUs(b));
+                bucket.add(stats->runtimeHistogram[b]);
+            }
+            if (stats->latenessHistogram[b])
+            {
+                JsonArray bucket = lateness.add<JsonArray>();
+                bucket.add(TaskScheduler::bucketUpperBoundUs(b));
+                bucket.add(stats->latenessHistogram[b]);
+            }
+        }
+    }
+
+    const ServoTaskStats &servoStats = servoTask.getStats();
+    JsonObject servo = response.data["servo_task"].to<JsonObject>();
+    servo["dual_core"] = servoTask.isDualCore();
+    servo["ticks"] = servoStats.ticks;
+    servo["commands"] = servoStats.commands;
+    servo["dropped"] = servoStats.dropped;
+    servo["acks_dropped"] = servoStats.acksDropped;
+    servo["targets"] = servoStats.targets;
+    servo["coalesced"] = servoStats.coalesced + servoStats.coalescedInTick;
+    servo["max_jitter_us"] = servoStats.maxJitterUs;
+
+    // 启动各阶段距上电的毫秒数，未到达的阶段省略
+    JsonObject boot = response.data["boot"].to<JsonObject>();
+    boot["reset_reason"] = bootProfiler.getResetReason();
+    JsonObject stages = boot["stages_ms"].to<JsonObject>();
+    for (int stage = 0; stage < BOOT_STAGE_COUNT; stage++)
+    {
+        if (bootProfiler.reached((BootStage)stage))
+        {
+            stages[BootProfiler::stageName((BootStage)stage)] = bootProfiler.getTimeUs((BootStage)stage) / 1000.0f;
+        }
+    }
+
+    if (server.hasArg("reset"))
+    {
+        scheduler.resetStats();
+    }
+
+    sendResponse(response);
+}
+
+// 在固定缓冲区中生成 Prometheus 文本格式，超出缓冲区的部分被截断
+class MetricsWriter
+{
+public:
+    MetricsWriter(char *buffer, size_t size) : _buffer(buffer), _size(size) {}
+
+    void printf(const char *format, ...)
+    {
+        if (_length >= _size)
+            return;
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(_buffer + _length, _size - _length, format, args);
+        va_end(args);
+        _length = n < 0 ? _length : min(_length + n, _size - 1);
+    }
+
+    void header(const char *name, const char *type, const char *help)
+    {
+        printf("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+    }
+
+    void value(const char *name, const char *type, const char *help, unsigned long value)
+    {
+        header(name, type, help);
+        printf("%s %lu\n", name, value);
+    }
+
+    size_t length() const { return _length; }
+
+private:
+    char *_buffer;
+    size_t _size;
+    size_t _length = 0;
+};
+
+static char metricsBuffer[METRICS_BUFFER_SIZE];
+
+// 无需打点的指标始终输出；命令计数与链路延迟直方图只在 ENABLE_TRACE 时输出
+void WebServerManager::handleMetrics()
+{
+    MetricsWriter out(metricsBuffer, sizeof(metricsBuffer));
+    out.value("servo_uptime_seconds", "gauge", "Seconds since boot", millis() / 1000);
+    out.value("servo_heap_free_bytes", "gauge", "Free heap", ESP.getFreeHeap());
+    out.value("servo_heap_min_free_bytes", "gauge", "Lowest free heap since boot (low watermark)", ESP.getMinFreeHeap());
+    out.value("servo_heap_used_peak_bytes", "gauge", "Peak heap usage since boot (high watermark)", ESP.getHeapSize() - ESP.getMinFreeHeap());
+    out.value("servo_wifi_connected", "gauge", "WiFi link state", deviceStatus.isWiFiConnected ? 1 : 0);
+    out.value("servo_mqtt_connected", "gauge", "MQTT session state", mqttManager.isConnected() ? 1 : 0);
+    out.value("servo_mqtt_duplicates_total", "counter", "Redelivered MQTT commands dropped by sequence de-duplication", mqttManager.getDuplicateCount());
+
+    const ServoTaskStats &servoStats = servoTask.getStats();
+    out.value("servo_task_ticks_total", "counter", "Servo task ticks", servoStats.ticks);
+    out.value("servo_task_commands_total", "counter", "Commands applied by the servo task", servoStats.commands);
+    out.value("servo_task_dropped_total", "counter", "Commands dropped because the servo queue was full", servoStats.dropped);
+    out.value("servo_task_targets_total", "counter", "Per-channel position targets posted to the servo mailbox", servoStats.targets);
+    out.value("servo_task_coalesced_total", "counter", "Position targets superseded before the servo task applied them", servoStats.coalesced + servoStats.coalescedInTick);
+    out.value("servo_task_max_jitter_us", "gauge", "Largest servo tick jitter", servoStats.maxJitterUs);
+
+    const HttpServerStats &httpStats = server.getStats();
+    out.value("servo_http_requests_total", "counter", "HTTP requests served", httpStats.requests);
+    out.value("servo_http_rejected_total", "counter", "HTTP connections or requests rejected", httpStats.rejected);
+    out.value("servo_http_connections", "gauge", "Open HTTP connections", server.getActiveConnections());
+
+#if ENABLE_TRACE
+    tracer.collect();
+    out.header("servo_commands_total", "counter", "Commands received, by transport");
+    for (int source = 0; source < TRACE_SOURCE_COUNT; source++)
+    {
+        out.printf("servo_commands_total{source=\"%s\"} %lu\n", Tracer::sourceName((TraceSource)source), tracer.getCommands((TraceSource)source));
+    }
+    out.value("servo_parse_failures_total", "counter", "Commands that failed to parse", tracer.getCounter(TRACE_PARSE_FAILURES));
+    out.value("servo_auth_failures_total", "counter", "Commands with a wrong password or frame tag", tracer.getCounter(TRACE_AUTH_FAILURES));
+    out.value("servo_mqtt_reconnects_total", "counter", "MQTT connection attempts", tracer.getCounter(TRACE_MQTT_RECONNECTS));
+    out.value("servo_wifi_reconnects_total", "counter", "WiFi link losses followed by a reconnect", tracer.getCounter(TRACE_WIFI_RECONNECTS));
+    out.value("servo_trace_dropped_total", "counter", "Servo write timestamps lost because the trace queue was full", tracer.getDroppedStamps());
+
+    // 直方图的桶按 Prometheus 约定累计输出
+    out.header("servo_command_latency_us", "histogram", "Time from command receipt to each pipeline stage");
+    for (int stage = TRACE_PARSE; stage < TRACE_STAGE_COUNT; stage++)
+    {
+        const char *name = Tracer::stageName((TraceStage)stage);
+        const TraceHistogram &histogram = tracer.getHistogram((TraceStage)stage);
+        uint32_t cumulative = 0;
+        for (int b = 0; b < TRACE_BUCKET_COUNT; b++)
+        {
+            cumulative += histogram.buckets[b];
+            out.printf("servo_command_latency_us_bucket{stage=\"%s\",le=\"%lu\"} %lu\n", name, (unsigned long)Tracer::bucketUpperBoundUs(b), (unsigned long)cumulative);
+        }
+        out.printf("servo_command_latency_us_bucket{stage=\"%s\",le=\"+Inf\"} %lu\n", name, (unsigned long)histogram.count);
+        out.printf("servo_command_latency_us_sum{stage=\"%s\"} %llu\n", name, (unsigned long long)histogram.sumUs);
+        out.printf("servo_command_latency_us_count{stage=\"%s\"} %lu\n", name, (unsigned long)histogram.count);
+    }
+#endif
+
+    server.send(200, "text/plain; version=0.0.4", metricsBuffer, out.length());
+}
+
+#if ENABLE_TRACE
+// 最近的命令记录，新的在前；各阶段为距收到命令的微秒数，未到达的阶段省略。?count= 限制条数
+void WebServerManager::handleTrace()
 {
+    tracer.collect();
+    int count = server.hasArg("count") ? server.arg("count").toInt() : 16;
+
+    Response response;
+    response.success = true;
+    JsonArray records = response.data["records"].to<JsonArray>();
+    for (int age = 0; age < count; age++)
+    {
+        const TraceRecord *record = tracer.getRecord(age);
+        if (!record)
+        {
+            break;
+        }
+        JsonObject item = records.add<JsonObject>();
+        item["id"] = record->id;
+        item["source"] = Tracer::sourceName((TraceSource)record->source);
+        JsonObject stages = item["stages_us"].to<JsonObject>();
+        for (int stage = TRACE_PARSE; stage < TRACE_STAGE_COUNT; stage++)
+        {
+            if (record->stages & (1 << stage))
+            {
+                stages[Tracer::stageName((TraceStage)stage)] = record->timeUs[stage] - record->timeUs[TRACE_RECEIVE];
+            }
+        }
+    }
+    sendResponse(response);
+}
+#endif
 
+void WebServerManager::handleControl()
+{
+    TRACE_BEGIN_AT(TRACE_SOURCE_HTTP, server.receivedUs());
     String json = server.arg("plain");
     JsonDocument doc;
     DeserializationError error = deserializeJson(doc, json);
 
     if (error)
     {
+        TRACE_COUNT(TRACE_PARSE_FAILURES);
         server.send(400, "application/json", "{\"success\":false,\"message\":\"解析JSON失败\"}");
         return;
     }
 
-    String command = doc["command"];
-    int position = doc["position"];
-    int restore = doc["restore"];
+    Command command;
+    CommandResult result = commandRouter.parse(doc, command);
+    if (result == COMMAND_OK)
+    {
+        TRACE_STAGE(TRACE_PARSE);
+        result = commandRouter.dispatch(command);
+    }
+    else
+    {
+        TRACE_COUNT(TRACE_PARSE_FAILURES);
+    }
+    if (result != COMMAND_OK)
+    {
+        String body = "{\"success\":false,\"message\":\"";
+        body += CommandRouter::resultMessage(result);
+        body += "\"}";
+        server.send(400, "application/json", body);
+        return;
+    }
 
-    if (command == "start")
+    Response response;
+    response.success = true;
+    response.message = CommandRouter::resultMessage(result);
+    sendResponse(response);
+}
+
+// 舵机标定，两部分可以单独提交，结果立即生效并写入配置存储：
+// 模型 {"channel":0,"samples":[[阶跃度数, 到位毫秒], ...]}，毫秒为 0 表示没有动作；
+// 脉宽 {"channel":0,"min_us":544,"max_us":2400,"correction_us":[...]}，修正表为 SERVO_CALIBRATION_POINTS 个点
+void WebServerManager::handleCalibrate()
+{
+    JsonDocument doc;
+    if (deserializeJson(doc, server.arg("plain")))
     {
-        servoController.setRunning(true);
-        deviceStatus.isServoRunning = true;
-        ledController.changeStatus(STATUS_SERVO_RUNNING);
+        server.send(400, "application/json", "{\"success\":false,\"message\":\"解析JSON失败\"}");
+        return;
     }
-    else if (command == "stop")
+
+    int channel = doc["channel"] | 0;
+    bool hasModel = doc["samples"].is<JsonArrayConst>();
+    bool hasPulse = doc["min_us"].is<int>() || doc["max_us"].is<int>() || doc["correction_us"].is<JsonArrayConst>();
+    if (channel < 0 || channel >= servoController.getChannelCount() || (!hasModel && !hasPulse))
     {
-        servoController.setRunning(false);
-        deviceStatus.isServoRunning = false;
-        ledController.changeStatus(STATUS_SERVO_STOPPED);
+        server.send(400, "application/json", "{\"success\":false,\"message\":\"缺少必要参数\"}");
+        return;
     }
-    else if (command == "position")
+
+    ServoModel model = configStore.data().model[channel];
+    if (hasModel)
     {
-        String lastStatus = ledController.getCurrentStatus();
-        ledController.changeStatus(STATUS_MQTT_RECEIVE);
-
-        int targetPosition = constrain(position, 0, 180);
-        int lastPosition = deviceStatus.servoPosition;
-        servoController.setPosition(targetPosition);
-        deviceStatus.servoPosition = targetPosition;
-        if (restore == 1)
+        ServoModelSample samples[SERVO_MODEL_MAX_SAMPLES];
+        int count = 0;
+        for (JsonArrayConst sample : doc["samples"].as<JsonArrayConst>())
+        {
+            if (count >= SERVO_MODEL_MAX_SAMPLES)
+            {
+                break;
+            }
+            samples[count].distance = (int32_t)(sample[0].as<float>() * 100 + 0.5f);
+            samples[count].durationMs = sample[1] | 0;
+            count++;
+        }
+        if (!ServoModelFitter::fit(samples, count, model))
+        {
+            server.send(400, "application/json", "{\"success\":false,\"message\":\"至少需要两个不同阶跃的有效测量\"}");
+            return;
+        }
+    }
+
+    ServoCalibration calibration = configStore.data().calibration[channel];
+    ServoCorrection correction = configStore.data().correction[channel];
+    if (hasPulse)
+    {
+        // 先按 int 读入并校验，再收窄到 uint16_t / int16_t，超出范围的值不会回绕成合法脉宽
+        int minUs = doc["min_us"] | (int)calibration.minPulseUs;
+        int maxUs = doc["max_us"] | (int)calibration.maxPulseUs;
+        JsonArrayConst offsets = doc["correction_us"].as<JsonArrayConst>();
+        bool valid = minUs >= SERVO_PULSE_LIMIT_MIN_US && maxUs <= SERVO_PULSE_LIMIT_MAX_US && minUs < maxUs &&
+                     (offsets.isNull() || offsets.size() == SERVO_CALIBRATION_POINTS);
+        const int maxOffset = SERVO_PULSE_LIMIT_MAX_US - SERVO_PULSE_LIMIT_MIN_US;
+        for (int i = 0; valid && !offsets.isNull() && i < SERVO_CALIBRATION_POINTS; i++)
+        {
+            int offset = offsets[i] | 0;
+            valid = offset >= -maxOffset && offset <= maxOffset;
+        }
+        if (!valid)
         {
-            delay(ServoController::calculateMoveTime(deviceStatus.servoPosition, targetPosition));
-            servoController.setPosition(deviceStatus.servoPosition);
-            deviceStatus.servoPosition = deviceStatus.servoPosition;
+            server.send(400, "application/json", "{\"success\":false,\"message\":\"脉宽范围或修正表无效\"}");
+            return;
         }
-        else
+        calibration.minPulseUs = (uint16_t)minUs;
+        calibration.maxPulseUs = (uint16_t)maxUs;
+        for (int i = 0; !offsets.isNull() && i < SERVO_CALIBRATION_POINTS; i++)
         {
-            deviceStatus.servoPosition = targetPosition;
+            correction.offsetUs[i] = (int16_t)(offsets[i] | 0);
         }
-        ledController.changeStatus(lastStatus);
+    }
+
+    // 两部分都校验通过后才生效，避免只应用一半；参数由舵机任务在节拍中应用
+    ServoCommand command = {};
+    command.op = SERVO_OP_CALIBRATE;
+    command.channels = 1UL << channel;
+    if (hasModel)
+    {
+        command.calibrate |= CALIBRATE_MODEL;
+    }
+    if (hasPulse)
+    {
+        command.calibrate |= CALIBRATE_PULSE;
+    }
+    command.model = model;
+    command.calibration = calibration;
+    command.correction = correction;
+    if (!servoTask.submit(command))
+    {
+        server.send(503, "application/json", "{\"success\":false,\"message\":\"舵机任务繁忙\"}");
+        return;
+    }
+    if (hasModel)
+    {
+        ServoModel models[SERVO_MAX_CHANNELS];
+        memcpy(models, configStore.data().model, sizeof(models));
+        models[channel] = model;
+        configStore.set(CONFIG_KEY_SERVO_MODEL, models);
+    }
+    if (hasPulse)
+    {
+        ServoCalibration calibrations[SERVO_MAX_CHANNELS];
+        ServoCorrection corrections[SERVO_MAX_CHANNELS];
+        memcpy(calibrations, configStore.data().calibration, sizeof(calibrations));
+        memcpy(corrections, configStore.data().correction, sizeof(corrections));
+        calibrations[channel] = calibration;
+        corrections[channel] = correction;
+        configStore.set(CONFIG_KEY_CALIBRATION, calibrations);
+        configStore.set(CONFIG_KEY_SERVO_CORRECTION, corrections);
     }
 
     Response response;
-    response.success = true;
-    response.message = "控制命令已接收";
+    response.success = configStore.commit();
+    response.message = response.success ? "标定已保存" : "标定已生效，但保存失败";
+    response.data["channel"] = channel;
+    response.data["speed"] = model.speed;
+    response.data["latency_ms"] = model.latencyMs;
+    response.data["deadband"] = model.deadband / 100.0f;
+    response.data["min_us"] = calibration.minPulseUs;
+    response.data["max_us"] = calibration.maxPulseUs;
+    JsonArray offsets = response.data["correction_us"].to<JsonArray>();
+    for (int i = 0; i < SERVO_CALIBRATION_POINTS; i++)
+    {
+        offsets.add(correction.offsetUs[i]);
+    }
     sendResponse(response);
 }
 
@@ -1,5 +1,8 @@
 #include "wifi_manager.h"
 #include "led_control.h"
+#include "config_store.h"
+#include "boot_profiler.h"
+#include "trace.h"
 #include <types.h>
 #include <config.h>
 
@@ -8,55 +11,89 @@ extern WiFiCredentials credentials;
 
 WiFiManager wifiManager;
 
-bool isAPMode = false;
-
 void WiFiManager::begin()
 {
     WiFi.mode(WIFI_STA);
     loadCredentials();
 }
 
+// 由调度器周期调用，推进连接状态机；任何分支都不阻塞
 void WiFiManager::update()
 {
-    if (isAPMode)
-    {
-        return; // AP模式下不再尝试重连
-    }
+    unsigned long now = millis();
 
-    if (deviceStatus.isWiFiConnecting)
+    switch (state)
     {
-        return;
+    case WIFI_STATE_SCANNING:
+    {
+        int16_t found = WiFi.scanComplete();
+        if (found == WIFI_SCAN_RUNNING && now - lastReconnectAttempt < WIFI_SCAN_TIMEOUT_MS)
+        {
+            break;
+        }
+        selectScannedNetwork();
+        break;
     }
 
-    static unsigned long lastCheck = 0;
-    unsigned long now = millis();
-
-    if (now - lastCheck > 5000)
+    case WIFI_STATE_CONNECTING:
     {
-        lastCheck = now;
-        if (WiFi.status() != WL_CONNECTED)
+        wl_status_t status = WiFi.status();
+        unsigned long timeout = attemptKind == WIFI_ATTEMPT_FAST ? WIFI_FAST_CONNECT_TIMEOUT_MS : CONNECT_TIMEOUT;
+        if (status == WL_CONNECTED)
         {
-            if (deviceStatus.isWiFiConnected)
+            onConnected();
+        }
+        else if (status == WL_CONNECT_FAILED || status == WL_NO_SSID_AVAIL || now - attemptStart >= timeout)
+        {
+            if (attemptKind == WIFI_ATTEMPT_FAST)
+            {
+                // 不计入重连次数，立即重试；多次失败说明接入点换了信道或已不可用，之后改为扫描
+                if (++fastFailures >= WIFI_FAST_CONNECT_ATTEMPTS)
+                {
+                    Serial.println("快速重连失败，改为扫描");
+                }
+                startAttempt();
+            }
+            else
             {
-                Serial.println("WiFi断开，尝试重新连接...");
-                deviceStatus.isWiFiConnected = false;
-                ledController.changeStatus(STATUS_WIFI_DISCONNECTED);
+                onAttemptFailed();
             }
-            WiFi.disconnect();
-            connect();
         }
-        else if (!deviceStatus.isWiFiConnected)
+        break;
+    }
+
+    case WIFI_STATE_CONNECTED:
+        if (WiFi.status() != WL_CONNECTED)
         {
-            deviceStatus.isWiFiConnected = true;
-            deviceStatus.wifiIP = WiFi.localIP().toString();
-            ledController.changeStatus(STATUS_WIFI_CONNECTED);
+            Serial.println("WiFi断开，尝试重新连接...");
+            TRACE_COUNT(TRACE_WIFI_RECONNECTS);
+            deviceStatus.isWiFiConnected = false;
+            ledController.changeStatus(STATUS_WIFI_DISCONNECTED);
+            // 掉线后的第一次重连立即进行
+            resetReconnectCount();
+            lastReconnectAttempt = now;
+            backoffDelay = 0;
+            state = WIFI_STATE_BACKOFF;
         }
+        break;
+
+    case WIFI_STATE_BACKOFF:
+        if (now - lastReconnectAttempt >= backoffDelay)
+        {
+            startAttempt();
+        }
+        break;
+
+    case WIFI_STATE_IDLE:
+    case WIFI_STATE_AP:
+        break; // AP模式下不再尝试重连
     }
 }
 
+// 发起一次非阻塞连接，结果由 update() 处理；没有保存凭证时返回 false
 bool WiFiManager::connect()
 {
-    if (strlen(credentials.ssid) == 0 || strlen(credentials.password) == 0)
+    if (getNetworkCount() == 0)
     {
         Serial.println("没有保存的WiFi凭证");
         return false;
@@ -72,60 +109,181 @@ bool WiFiManager::connect()
         return true;
     }
 
-    Serial.println("尝试连接WiFi...");
-    Serial.print("SSID: ");
-    Serial.println(credentials.ssid);
-    Serial.print("密码: ");
-    Serial.println(credentials.password);
-    Serial.print("重连次数: ");
+    startAttempt();
+    return true;
+}
+
+void WiFiManager::startAttempt()
+{
+    Serial.print("尝试连接WiFi，重连次数: ");
     Serial.println(reconnectAttempts + 1);
 
     deviceStatus.isWiFiConnecting = true;
     ledController.changeStatus(STATUS_WIFI_CONNECTING);
-    WiFi.disconnect(true);
-    delay(1000);
-    WiFi.begin(credentials.ssid, credentials.password);
+    lastReconnectAttempt = millis();
+    WiFi.disconnect();
 
-    // 等待连接建立
-    int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts < 30)
+    const ConfigData &config = configStore.data();
+    const WiFiFastConnect &cache = config.wifiCache;
+    if (fastFailures < WIFI_FAST_CONNECT_ATTEMPTS && cache.channel && cache.network < WIFI_MAX_NETWORKS && config.networks[cache.network].ssid[0])
     {
-        delay(1000);
-        Serial.print(".");
-        attempts++;
+#if WIFI_REUSE_IP_LEASE
+        if (cache.ip)
+        {
+            WiFi.config(IPAddress(cache.ip), IPAddress(cache.gateway), IPAddress(cache.subnet), IPAddress(cache.dns));
+        }
+#endif
+        beginNetwork(cache.network, cache.channel, cache.bssid, WIFI_ATTEMPT_FAST);
+        return;
     }
 
-    Serial.println("");
+    // 没有可用的缓存：恢复 DHCP 并异步扫描
+    WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+    WiFi.scanNetworks(true);
+    state = WIFI_STATE_SCANNING;
+}
 
-    if (WiFi.status() == WL_CONNECTED)
+// 在扫描结果中选择优先级最高的已知网络，同一网络有多个接入点时选信号最强的
+void WiFiManager::selectScannedNetwork()
+{
+    const WiFiCredentials *networks = configStore.data().networks;
+    int16_t found = WiFi.scanComplete();
+    int best = -1;
+    int bestRank = WIFI_MAX_NETWORKS;
+    int32_t bestRssi = 0;
+    for (int i = 0; i < found; i++)
     {
-        Serial.println("\nWiFi连接成功!");
-        Serial.print("IP地址: ");
-        Serial.println(WiFi.localIP());
-        deviceStatus.wifiIP = WiFi.localIP().toString();
-        deviceStatus.wifiSSID = credentials.ssid;
-        deviceStatus.isWiFiConnected = true;
-        ledController.changeStatus(STATUS_WIFI_CONNECTED);
-        resetReconnectCount();
-        return true;
+        String ssid = WiFi.SSID(i);
+        for (int rank = 0; rank < WIFI_MAX_NETWORKS; rank++)
+        {
+            if (networks[rank].ssid[0] == '\0' || ssid != networks[rank].ssid)
+            {
+                continue;
+            }
+            int32_t rssi = WiFi.RSSI(i);
+            if (rank < bestRank || (rank == bestRank && rssi > bestRssi))
+            {
+                best = i;
+                bestRank = rank;
+                bestRssi = rssi;
+            }
+            break;
+        }
+    }
+
+    if (best >= 0)
+    {
+        uint8_t bssid[6];
+        memcpy(bssid, WiFi.BSSID(best), sizeof(bssid));
+        int32_t channel = WiFi.channel(best);
+        WiFi.scanDelete();
+        beginNetwork(bestRank, channel, bssid, WIFI_ATTEMPT_SCANNED);
+        return;
     }
 
+    WiFi.scanDelete();
+    for (int i = 0; i < WIFI_MAX_NETWORKS; i++)
+    {
+        int index = (blindNetwork + i) % WIFI_MAX_NETWORKS;
+        if (networks[index].ssid[0] != '\0')
+        {
+            blindNetwork = index;
+            beginNetwork(index, 0, nullptr, WIFI_ATTEMPT_BLIND);
+            return;
+        }
+    }
+    onAttemptFailed();
+}
+
+void WiFiManager::beginNetwork(int index, int32_t channel, const uint8_t *bssid, WiFiAttempt kind)
+{
+    const WiFiCredentials &network = configStore.data().networks[index];
+    Serial.print("SSID: ");
+    Serial.print(network.ssid);
+    if (channel > 0)
+    {
+        Serial.print(" 信道: ");
+        Serial.print(channel);
+    }
+    Serial.println(kind == WIFI_ATTEMPT_FAST ? "（缓存）" : "");
+
+    WiFi.begin(network.ssid, network.password, channel, bssid);
+    attemptNetwork = index;
+    attemptKind = kind;
+    attemptStart = millis();
+    state = WIFI_STATE_CONNECTING;
+}
+
+void WiFiManager::onConnected()
+{
+    lastConnectDuration = millis() - lastReconnectAttempt;
+    Serial.print("WiFi连接成功，耗时 ");
+    Serial.print(lastConnectDuration);
+    Serial.println(" ms");
+    Serial.print("IP地址: ");
+    Serial.println(WiFi.localIP());
+    deviceStatus.wifiIP = WiFi.localIP().toString();
+    deviceStatus.wifiSSID = configStore.data().networks[attemptNetwork].ssid;
+    deviceStatus.isWiFiConnected = true;
+    deviceStatus.isWiFiConnecting = false;
+    ledController.changeStatus(STATUS_WIFI_CONNECTED);
+    bootProfiler.mark(BOOT_WIFI_CONNECTED);
+    resetReconnectCount();
+    fastFailures = 0;
+    state = WIFI_STATE_CONNECTED;
+
+    // 缓存本次的接入点与 IP 租约；与上次相同时 set() 不标记修改，commit() 不写闪存
+    WiFiFastConnect cache = {};
+    const uint8_t *bssid = WiFi.BSSID();
+    if (bssid)
+    {
+        memcpy(cache.bssid, bssid, sizeof(cache.bssid));
+        cache.channel = WiFi.channel();
+    }
+    cache.network = attemptNetwork;
+    cache.ip = WiFi.localIP();
+    cache.gateway = WiFi.gatewayIP();
+    cache.subnet = WiFi.subnetMask();
+    cache.dns = WiFi.dnsIP();
+    configStore.set(CONFIG_KEY_WIFI_CACHE, cache);
+    configStore.commit();
+}
+
+void WiFiManager::onAttemptFailed()
+{
+    deviceStatus.isWiFiConnecting = false;
     reconnectAttempts++;
+    if (attemptKind == WIFI_ATTEMPT_BLIND)
+    {
+        blindNetwork = (attemptNetwork + 1) % WIFI_MAX_NETWORKS;
+    }
 
-    // 如果还有重试机会，则递归调用connect()
-    if (reconnectAttempts < MAX_RECONNECT_ATTEMPTS)
+    if (reconnectAttempts >= MAX_RECONNECT_ATTEMPTS)
     {
-        Serial.println("连接失败，准备重试...");
-        delay(1000); // 等待1秒后重试
-        return connect();
+        Serial.println("已达到最大重连次数");
+        ledController.changeStatus(STATUS_WIFI_ERROR);
+        Serial.println("尝试启动AP模式");
+        setupAP();
+        return;
     }
 
-    return false;
+    // 指数退避加随机抖动：取退避上限的一半再加上 [0, 一半) 的随机量，避免多台设备同时重连
+    unsigned long cap = BACKOFF_BASE << (reconnectAttempts - 1);
+    if (cap > BACKOFF_MAX)
+    {
+        cap = BACKOFF_MAX;
+    }
+    backoffDelay = cap / 2 + random(cap / 2);
+    Serial.print("连接失败，");
+    Serial.print(backoffDelay);
+    Serial.println("ms 后重试...");
+    state = WIFI_STATE_BACKOFF;
 }
 
 void WiFiManager::setupAP()
 {
-    isAPMode = true;
+    state = WIFI_STATE_AP;
+    deviceStatus.isWiFiConnecting = false;
     WiFi.mode(WIFI_AP);
     WiFi.softAP(AP_SSID, AP_PASSWORD);
     Serial.println("AP模式已启动");
@@ -143,18 +301,37 @@ bool WiFiManager::resetSettings()
 
 bool WiFiManager::saveCredentials(const char *ssid, const char *password)
 {
-    if (!ssid || !password)
+    if (!ssid || !password || ssid[0] == '\0')
         return false;
 
-    strncpy(credentials.ssid, ssid, sizeof(credentials.ssid) - 1);
-    strncpy(credentials.password, password, sizeof(credentials.password) - 1);
+    WiFiCredentials networks[WIFI_MAX_NETWORKS];
+    memcpy(networks, configStore.data().networks, sizeof(networks));
+
+    // 移除同名网络，其余网络依次后移，超出容量的最低优先级网络被丢弃
+    int last = WIFI_MAX_NETWORKS - 1;
+    for (int i = 0; i < WIFI_MAX_NETWORKS; i++)
+    {
+        if (strncmp(networks[i].ssid, ssid, sizeof(networks[i].ssid)) == 0)
+        {
+            last = i;
+            break;
+        }
+    }
+    memmove(&networks[1], &networks[0], last * sizeof(WiFiCredentials));
+    memset(&networks[0], 0, sizeof(WiFiCredentials));
+    strncpy(networks[0].ssid, ssid, sizeof(networks[0].ssid) - 1);
+    strncpy(networks[0].password, password, sizeof(networks[0].password) - 1);
 
-    EEPROM.put(0, credentials);
-    bool success = EEPROM.commit();
+    // 网络列表与缓存在同一次提交中写入，缓存中的下标随列表变化而失效
+    WiFiFastConnect cache = {};
+    configStore.set(CONFIG_KEY_WIFI, networks);
+    configStore.set(CONFIG_KEY_WIFI_CACHE, cache);
+    bool success = configStore.commit();
 
     if (success)
     {
         Serial.println("WiFi凭证已保存");
+        loadCredentials();
         deviceStatus.wifiSSID = ssid;
         deviceStatus.wifiPasswd = password;
     }
@@ -164,9 +341,7 @@ bool WiFiManager::saveCredentials(const char *ssid, const char *password)
 
 bool WiFiManager::reconnect()
 {
-    lastReconnectAttempt = millis();
-
-    if (strlen(credentials.ssid) == 0)
+    if (getNetworkCount() == 0)
     {
         return false;
     }
@@ -178,22 +353,38 @@ bool WiFiManager::reconnect()
     }
 
     Serial.println("尝试重新连接WiFi...");
-    WiFi.disconnect();
-    delay(1000);
-    return connect();
+    startAttempt();
+    return true;
 }
 
+// 首选网络的密码同时用作命令密码
 bool WiFiManager::loadCredentials()
 {
-    EEPROM.get(0, credentials);
-    return (strlen(credentials.ssid) > 0);
+    credentials = configStore.data().networks[0];
+    return getNetworkCount() > 0;
+}
+
+int WiFiManager::getNetworkCount() const
+{
+    int count = 0;
+    for (const WiFiCredentials &network : configStore.data().networks)
+    {
+        if (network.ssid[0] != '\0')
+        {
+            count++;
+        }
+    }
+    return count;
 }
 
 void WiFiManager::clearCredentials()
 {
+    WiFiCredentials networks[WIFI_MAX_NETWORKS] = {};
+    WiFiFastConnect cache = {};
+    configStore.set(CONFIG_KEY_WIFI, networks);
+    configStore.set(CONFIG_KEY_WIFI_CACHE, cache);
+    configStore.commit();
     memset(&credentials, 0, sizeof(WiFiCredentials));
-    EEPROM.put(0, credentials);
-    EEPROM.commit();
 }
 
 void WiFiManager::resetReconnectCount()
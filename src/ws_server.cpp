@@ -0,0 +1,101 @@
+#include "ws_server.h"
+#include "servo_task.h"
+#include "command_router.h"
+#include "trace.h"
+
+WebSocketManager wsManager;
+
+static WebSocketsServer webSocket(WS_PORT);
+
+void WebSocketManager::begin()
+{
+    webSocket.begin();
+    webSocket.onEvent(onEvent);
+}
+
+void WebSocketManager::update()
+{
+    webSocket.loop();
+    pushStatus();
+}
+
+void WebSocketManager::onEvent(uint8_t num, WStype_t type, uint8_t *payload, size_t length)
+{
+    switch (type)
+    {
+    case WStype_CONNECTED:
+    {
+        // 新连接立即发送一次完整状态
+        char buffer[128];
+        size_t size = wsManager.buildStatus(buffer, sizeof(buffer));
+        webSocket.sendTXT(num, buffer, size);
+        break;
+    }
+    case WStype_BIN:
+        handleBinary(payload, length);
+        break;
+    default:
+        break;
+    }
+}
+
+// 滑块位置帧：直接改变目标位置，不经过 JSON 解析
+void WebSocketManager::handleBinary(const uint8_t *payload, size_t length)
+{
+    TRACE_BEGIN(TRACE_SOURCE_WS);
+    if (length != WS_FRAME_SIZE || payload[0] != WS_OP_POSITION)
+    {
+        TRACE_COUNT(TRACE_PARSE_FAILURES);
+        return;
+    }
+    TRACE_STAGE(TRACE_PARSE);
+    Command command;
+    command.type = CMD_POSITION;
+    command.position = payload[2] | (payload[3] << 8);
+    command.restore = false;
+    command.channel = payload[1];
+    command.group = -1;
+    command.loops = 0;
+    command.frameCount = 0;
+    command.ack.route = 0;
+    commandRouter.dispatch(command);
+}
+
+// 字段名与 /status 一致，网页用同一个函数更新显示
+size_t WebSocketManager::buildStatus(char *buffer, size_t size)
+{
+    const ServoSnapshot &servo = servoTask.snapshot();
+    JsonDocument doc;
+    doc["servo_position"] = servo.channels[0].position;
+    doc["target"] = servo.channels[0].target;
+    doc["is_running"] = servo.runningMask != 0;
+    return serializeJson(doc, buffer, size);
+}
+
+// 状态变化时推送，两次推送至少间隔 WS_PUSH_INTERVAL_MS
+void WebSocketManager::pushStatus()
+{
+    unsigned long now = millis();
+    if (now - lastPushTime < WS_PUSH_INTERVAL_MS || webSocket.connectedClients() == 0)
+    {
+        return;
+    }
+
+    const ServoSnapshot &servo = servoTask.snapshot();
+    int position = servo.channels[0].position;
+    int target = servo.channels[0].target;
+    bool running = servo.runningMask != 0;
+    if (position == lastPosition && target == lastTarget && running == lastRunning)
+    {
+        return;
+    }
+
+    lastPushTime = now;
+    lastPosition = position;
+    lastTarget = target;
+    lastRunning = running;
+
+    char buffer[128];
+    size_t size = buildStatus(buffer, sizeof(buffer));
+    webSocket.broadcastTXT(buffer, size);
+}
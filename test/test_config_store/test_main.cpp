@@ -0,0 +1,114 @@
+// 配置存储：在 sim_flash.cpp 的文件镜像上验证提交、重启恢复、换页与掉电
+#include <unity.h>
+#include <sim.h>
+#include <stdlib.h>
+#include "config_store.h"
+
+static void writeNetwork(ConfigStore &store, const char *ssid, uint16_t port)
+{
+    WiFiCredentials networks[WIFI_MAX_NETWORKS] = {};
+    strncpy(networks[0].ssid, ssid, sizeof(networks[0].ssid) - 1);
+    strcpy(networks[0].password, "password");
+    store.set(CONFIG_KEY_WIFI, networks);
+    MqttSettings mqtt = store.data().mqtt;
+    mqtt.port = port;
+    store.set(CONFIG_KEY_MQTT, mqtt);
+}
+
+void setUp()
+{
+    sim::flashErase();
+}
+
+void tearDown() {}
+
+void test_empty_partition_uses_defaults()
+{
+    ConfigStore store;
+    TEST_ASSERT_TRUE(store.begin());
+    TEST_ASSERT_EQUAL(-1, store.getStats().activePage);
+    TEST_ASSERT_EQUAL_STRING("", store.data().networks[0].ssid);
+    TEST_ASSERT_EQUAL(MQTT_PORT, store.data().mqtt.port);
+    TEST_ASSERT_EQUAL(SERVO_MIN_PULSE_US, store.data().calibration[0].minPulseUs);
+}
+
+void test_commit_survives_reboot()
+{
+    {
+        ConfigStore store;
+        store.begin();
+        writeNetwork(store, "home", 1884);
+        TEST_ASSERT_TRUE(store.commit());
+    }
+    sim::flashReload();
+    ConfigStore store;
+    TEST_ASSERT_TRUE(store.begin());
+    TEST_ASSERT_EQUAL_STRING("home", store.data().networks[0].ssid);
+    TEST_ASSERT_EQUAL(1884, store.data().mqtt.port);
+    TEST_ASSERT_EQUAL(0, store.getStats().corruptRecords);
+}
+
+// 反复提交写满当前页后换页，只保留最新的值，擦除次数远少于提交次数
+void test_compaction_keeps_latest_values()
+{
+    unsigned long erasesBefore = sim::flashEraseCount();
+    {
+        ConfigStore store;
+        store.begin();
+        for (int i = 0; i < 100; i++)
+        {
+            char ssid[16];
+            snprintf(ssid, sizeof(ssid), "net%d", i);
+            writeNetwork(store, ssid, 1000 + i);
+            TEST_ASSERT_TRUE(store.commit());
+        }
+        TEST_ASSERT_GREATER_THAN(0, store.getStats().compactions);
+    }
+    TEST_ASSERT_LESS_THAN(20, sim::flashEraseCount() - erasesBefore);
+
+    sim::flashReload();
+    ConfigStore store;
+    store.begin();
+    TEST_ASSERT_EQUAL_STRING("net99", store.data().networks[0].ssid);
+    TEST_ASSERT_EQUAL(1099, store.data().mqtt.port);
+}
+
+// 提交写到一半掉电：重启后丢弃未完成的批次，两个键都保持上一次提交的值
+void test_torn_commit_rolls_back()
+{
+    {
+        ConfigStore store;
+        store.begin();
+        writeNetwork(store, "before", 2000);
+        TEST_ASSERT_TRUE(store.commit());
+        writeNetwork(store, "after", 2001);
+        sim::flashCutPowerAfter(sizeof(WiFiCredentials) + 16);
+        TEST_ASSERT_FALSE(store.commit());
+    }
+    sim::flashReload();
+    ConfigStore store;
+    store.begin();
+    TEST_ASSERT_EQUAL_STRING("before", store.data().networks[0].ssid);
+    TEST_ASSERT_EQUAL(2000, store.data().mqtt.port);
+    TEST_ASSERT_EQUAL(1, store.getStats().corruptRecords);
+
+    // 下一次提交换到新页，之后仍可正常恢复
+    writeNetwork(store, "again", 2002);
+    TEST_ASSERT_TRUE(store.commit());
+    sim::flashReload();
+    ConfigStore rebooted;
+    rebooted.begin();
+    TEST_ASSERT_EQUAL_STRING("again", rebooted.data().networks[0].ssid);
+    TEST_ASSERT_EQUAL(0, rebooted.getStats().corruptRecords);
+}
+
+int main()
+{
+    setenv("SIM_FLASH_FILE", "test_config_store.bin", 1);
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_partition_uses_defaults);
+    RUN_TEST(test_commit_survives_reboot);
+    RUN_TEST(test_compaction_keeps_latest_values);
+    RUN_TEST(test_torn_commit_rolls_back);
+    return UNITY_END();
+}
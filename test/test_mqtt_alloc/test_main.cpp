@@ -0,0 +1,72 @@
+// MQTT 命令路径不分配堆内存：callback() 前后 heapAllocationCount() 不变
+#include <unity.h>
+#include <sim.h>
+#include "mqtt_client.h"
+#include "servo_control.h"
+
+extern WiFiCredentials credentials;
+
+struct MqttClientTestAccess
+{
+    static void deliver(const char *topic, const char *payload)
+    {
+        static char topicBuffer[64];
+        static byte payloadBuffer[256];
+        strncpy(topicBuffer, topic, sizeof(topicBuffer) - 1);
+        size_t length = strlen(payload);
+        memcpy(payloadBuffer, payload, length);
+        MQTTClientManager::callback(topicBuffer, payloadBuffer, length);
+    }
+};
+
+static const char *PASSWORD = "test-password";
+
+static void assertNoAllocation(const char *payload)
+{
+    // 第一次调用可能初始化函数内的静态对象，不计入
+    MqttClientTestAccess::deliver(MQTT_TOPIC, payload);
+
+    unsigned long before = sim::heapAllocationCount();
+    for (int i = 0; i < 8; i++)
+    {
+        MqttClientTestAccess::deliver(MQTT_TOPIC, payload);
+    }
+    TEST_ASSERT_EQUAL(before, sim::heapAllocationCount());
+}
+
+void setUp()
+{
+    strcpy(credentials.password, PASSWORD);
+}
+
+void tearDown() {}
+
+void test_position_command()
+{
+    assertNoAllocation("{\"command\":\"position\",\"channel\":0,\"position\":90,\"pwd\":\"test-password\"}");
+}
+
+void test_sequenced_command()
+{
+    assertNoAllocation("{\"command\":\"position\",\"channel\":1,\"position\":45.5,\"seq\":7,\"pwd\":\"test-password\"}");
+}
+
+void test_rejected_commands()
+{
+    assertNoAllocation("{\"command\":\"position\",\"position\":90,\"pwd\":\"wrong\"}");
+    assertNoAllocation("{\"command\":\"unknown\",\"pwd\":\"test-password\"}");
+    assertNoAllocation("{\"command\":");
+}
+
+int main()
+{
+    // 初始化一个通道，命令才能一路分发到舵机任务；不启动任务，也不连接 broker
+    static const int pins[] = {9};
+    servoController.begin(pins, 1);
+    mqttManager.begin(); // 建立输入过滤器
+    UNITY_BEGIN();
+    RUN_TEST(test_position_command);
+    RUN_TEST(test_sequenced_command);
+    RUN_TEST(test_rejected_commands);
+    return UNITY_END();
+}
@@ -0,0 +1,231 @@
+// ServoTask：邮箱后写覆盖先写、position 与队列命令按提交顺序执行，
+// 以及网络任务和舵机任务分别在两个真实线程上运行时回执的顺序与完整性
+#include <unity.h>
+#include <sim.h>
+#include <atomic>
+#include <thread>
+#include "servo_task.h"
+#include "command_router.h"
+
+static const uint8_t ROUTE_TEST = 1;
+static const uint32_t THREAD_COMMAND_COUNT = 200000;
+static const uint32_t THREAD_OP_INTERVAL = 64; // 每隔这么多条 position 命令插入一条经队列执行的命令
+
+static uint32_t nextSequence = 1;
+
+// 线程测试中第 index 条命令是否为队列命令；最后一段只有 position 命令，结束时的目标是确定的
+static bool isQueuedOp(uint32_t index)
+{
+    return index % THREAD_OP_INTERVAL == THREAD_OP_INTERVAL / 2;
+}
+
+static ServoCommand makeCommand(ServoOp op, uint32_t channels, int16_t position = 0)
+{
+    ServoCommand command = {};
+    command.op = op;
+    command.channels = channels;
+    command.position = position;
+    command.ack.route = ROUTE_TEST;
+    command.ack.sequence = nextSequence++;
+    return command;
+}
+
+static ServoCommand makeSequence(uint32_t channels)
+{
+    ServoCommand command = makeCommand(SERVO_OP_SEQUENCE, channels);
+    command.frameCount = 2;
+    command.frames[0] = {4500, 500, 0};
+    command.frames[1] = {13500, 500, 0};
+    return command;
+}
+
+void setUp()
+{
+    CommandAck ack;
+    while (servoTask.pollAck(ack))
+    {
+    }
+}
+
+void tearDown() {}
+
+// 同一通道在一个节拍内的多个目标只执行最后一个，其余的回执为 COMMAND_SUPERSEDED
+void test_mailbox_keeps_latest_target()
+{
+    ServoTaskStats before = servoTask.getStats();
+    uint32_t first = nextSequence;
+    TEST_ASSERT_TRUE(servoTask.submit(makeCommand(SERVO_OP_MOVE, 1, 1000)));
+    TEST_ASSERT_TRUE(servoTask.submit(makeCommand(SERVO_OP_MOVE, 1, 2000)));
+    TEST_ASSERT_TRUE(servoTask.submit(makeCommand(SERVO_OP_MOVE, 1, 3000)));
+    servoTask.tick();
+
+    TEST_ASSERT_EQUAL(30, servoTask.snapshot().channels[0].target);
+    CommandAck ack;
+    int superseded = 0;
+    int applied = 0;
+    while (servoTask.pollAck(ack))
+    {
+        if (ack.result == COMMAND_OK)
+        {
+            TEST_ASSERT_EQUAL(first + 2, ack.sequence);
+            applied++;
+        }
+        else
+        {
+            TEST_ASSERT_EQUAL(COMMAND_SUPERSEDED, ack.result);
+            TEST_ASSERT_LESS_THAN(first + 2, ack.sequence);
+            superseded++;
+        }
+    }
+    TEST_ASSERT_EQUAL(1, applied);
+    TEST_ASSERT_EQUAL(2, superseded);
+
+    ServoTaskStats after = servoTask.getStats();
+    TEST_ASSERT_EQUAL(before.coalesced + 2, after.coalesced);
+    TEST_ASSERT_EQUAL(before.commands + 1, after.commands);
+}
+
+// 邮箱中的目标与队列中的命令按提交顺序交错执行：position 在 sequence 之前提交则先执行，之后提交则覆盖 sequence
+void test_targets_and_queued_ops_keep_submit_order()
+{
+    uint32_t first = nextSequence;
+    TEST_ASSERT_TRUE(servoTask.submit(makeCommand(SERVO_OP_MOVE, 1, 4500)));
+    TEST_ASSERT_TRUE(servoTask.submit(makeSequence(1)));
+    servoTask.tick();
+    TEST_ASSERT_EQUAL(1, servoTask.snapshot().sequenceMask & 1);
+
+    TEST_ASSERT_TRUE(servoTask.submit(makeSequence(1)));
+    TEST_ASSERT_TRUE(servoTask.submit(makeCommand(SERVO_OP_MOVE, 1, 9000)));
+    servoTask.tick();
+    TEST_ASSERT_EQUAL(0, servoTask.snapshot().sequenceMask & 1);
+    TEST_ASSERT_EQUAL(90, servoTask.snapshot().channels[0].target);
+
+    // 回执按执行顺序返回
+    CommandAck ack;
+    for (uint32_t sequence = first; sequence < first + 4; sequence++)
+    {
+        TEST_ASSERT_TRUE(servoTask.pollAck(ack));
+        TEST_ASSERT_EQUAL(COMMAND_OK, ack.result);
+        TEST_ASSERT_EQUAL(sequence, ack.sequence);
+    }
+    TEST_ASSERT_FALSE(servoTask.pollAck(ack));
+}
+
+// 网络任务线程不断向两个通道提交 position 命令并穿插 start 命令，舵机任务线程不断 tick()。
+// 每条命令恰好得到一个回执（或计入 acksDropped）；同一通道执行的目标序号只增不减；
+// 队列命令之前提交的目标不会在它之后执行，之后提交的目标不会在它之前执行
+void test_threads_keep_submit_order()
+{
+    static std::atomic<bool> stop{false};
+    std::thread servo([]() {
+        while (!stop.load())
+        {
+            servoTask.tick();
+            std::this_thread::yield();
+        }
+    });
+
+    ServoTaskStats before = servoTask.getStats();
+    uint32_t first = nextSequence;
+    uint32_t lastApplied[2] = {0, 0};
+    uint32_t lastOp = 0;         // 最近执行的队列命令
+    uint32_t maxMoveApplied = 0; // 已执行的 position 命令的最大序号
+    uint32_t acked = 0;
+    uint32_t superseded = 0;
+    uint32_t errors = 0;
+    int16_t lastPosition[2] = {0, 0};
+
+    auto drainAcks = [&]() {
+        CommandAck ack;
+        while (servoTask.pollAck(ack))
+        {
+            acked++;
+            if (ack.result == COMMAND_SUPERSEDED)
+            {
+                superseded++;
+                continue;
+            }
+            if (ack.result != COMMAND_OK)
+            {
+                errors++;
+                continue;
+            }
+            uint32_t index = ack.sequence - first;
+            if (isQueuedOp(index))
+            {
+                if (maxMoveApplied > ack.sequence || lastOp > ack.sequence)
+                {
+                    errors++;
+                }
+                lastOp = ack.sequence;
+                continue;
+            }
+            int ch = index % 2;
+            if (ack.sequence <= lastApplied[ch] || ack.sequence < lastOp)
+            {
+                errors++;
+            }
+            lastApplied[ch] = ack.sequence;
+            if (ack.sequence > maxMoveApplied)
+            {
+                maxMoveApplied = ack.sequence;
+            }
+        }
+    };
+
+    for (uint32_t i = 0; i < THREAD_COMMAND_COUNT; i++)
+    {
+        ServoCommand command;
+        if (isQueuedOp(i))
+        {
+            command = makeCommand(SERVO_OP_START, 3);
+        }
+        else
+        {
+            int ch = i % 2;
+            lastPosition[ch] = (int16_t)(i * 7 % 18001);
+            command = makeCommand(SERVO_OP_MOVE, 1UL << ch, lastPosition[ch]);
+        }
+        // 队列满时等舵机任务取走再重新提交
+        while (!servoTask.submit(command))
+        {
+            drainAcks();
+            std::this_thread::yield();
+        }
+        drainAcks();
+    }
+
+    // 等所有回执到达，丢弃的回执计入 acksDropped
+    for (int i = 0; i < 1000000; i++)
+    {
+        drainAcks();
+        ServoTaskStats stats = servoTask.getStats();
+        if (acked + stats.acksDropped - before.acksDropped >= THREAD_COMMAND_COUNT)
+        {
+            break;
+        }
+        std::this_thread::yield();
+    }
+    stop.store(true);
+    servo.join();
+
+    ServoTaskStats after = servoTask.getStats();
+    TEST_ASSERT_EQUAL(0, errors);
+    TEST_ASSERT_EQUAL(THREAD_COMMAND_COUNT, acked + after.acksDropped - before.acksDropped);
+    TEST_ASSERT_GREATER_THAN(0, superseded); // 两个线程确实发生过覆盖
+    const ServoSnapshot &snapshot = servoTask.snapshot();
+    TEST_ASSERT_EQUAL((lastPosition[0] + 50) / 100, snapshot.channels[0].target);
+    TEST_ASSERT_EQUAL((lastPosition[1] + 50) / 100, snapshot.channels[1].target);
+}
+
+int main()
+{
+    // 不调用 servoTask.begin()，由测试自己在网络任务与舵机任务的位置调用 submit() 与 tick()
+    static const int pins[] = {9, 10};
+    servoController.begin(pins, 2);
+    UNITY_BEGIN();
+    RUN_TEST(test_mailbox_keeps_latest_target);
+    RUN_TEST(test_targets_and_queued_ops_keep_submit_order);
+    RUN_TEST(test_threads_keep_submit_order);
+    return UNITY_END();
+}
@@ -0,0 +1,136 @@
+// SPSC 队列：单线程语义，以及两个真实线程分别充当网络任务和舵机任务时的顺序与完整性
+#include <unity.h>
+#include <stdint.h>
+#include <thread>
+#include "spsc_queue.h"
+
+struct Item
+{
+    uint32_t sequence;
+    uint32_t check; // sequence 的反码，检查元素是否被读到一半
+};
+
+static const uint32_t ITEM_COUNT = 1000000;
+
+void setUp() {}
+void tearDown() {}
+
+void test_capacity_is_one_less_than_size()
+{
+    SpscQueue<int, 8> queue;
+    TEST_ASSERT_TRUE(queue.empty());
+    for (int i = 0; i < 7; i++)
+    {
+        TEST_ASSERT_TRUE(queue.push(i));
+    }
+    TEST_ASSERT_FALSE(queue.push(7));
+
+    int value = -1;
+    TEST_ASSERT_TRUE(queue.pop(value));
+    TEST_ASSERT_EQUAL(0, value);
+    TEST_ASSERT_TRUE(queue.push(7));
+}
+
+void test_front_and_drop()
+{
+    SpscQueue<int, 4> queue;
+    TEST_ASSERT_NULL(queue.front());
+    queue.push(1);
+    queue.push(2);
+    TEST_ASSERT_EQUAL(1, *queue.front());
+    queue.drop();
+    TEST_ASSERT_EQUAL(2, *queue.front());
+    queue.drop();
+    TEST_ASSERT_TRUE(queue.empty());
+}
+
+// 队列很小，生产者和消费者不断在满和空之间切换，每个元素必须按顺序、完整地到达一次
+void test_threads_keep_order_without_loss()
+{
+    static SpscQueue<Item, 16> queue;
+    std::thread producer([]() {
+        for (uint32_t i = 0; i < ITEM_COUNT; i++)
+        {
+            Item item = {i, ~i};
+            while (!queue.push(item))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    uint32_t torn = 0;
+    uint32_t outOfOrder = 0;
+    while (expected < ITEM_COUNT)
+    {
+        Item item;
+        if (!queue.pop(item))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        if (item.check != ~item.sequence)
+        {
+            torn++;
+        }
+        if (item.sequence != expected)
+        {
+            outOfOrder++;
+        }
+        expected = item.sequence + 1;
+    }
+    producer.join();
+
+    TEST_ASSERT_EQUAL(0, torn);
+    TEST_ASSERT_EQUAL(0, outOfOrder);
+    TEST_ASSERT_TRUE(queue.empty());
+}
+
+// 消费者用 front()/drop() 先看后取（ServoTask 的合并逻辑就是这样读队列的）
+void test_threads_front_drop()
+{
+    static SpscQueue<Item, 16> queue;
+    std::thread producer([]() {
+        for (uint32_t i = 0; i < ITEM_COUNT; i++)
+        {
+            Item item = {i, ~i};
+            while (!queue.push(item))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    uint32_t errors = 0;
+    while (expected < ITEM_COUNT)
+    {
+        const Item *item = queue.front();
+        if (item == nullptr)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        if (item->sequence != expected || item->check != ~expected)
+        {
+            errors++;
+        }
+        queue.drop();
+        expected++;
+    }
+    producer.join();
+
+    TEST_ASSERT_EQUAL(0, errors);
+    TEST_ASSERT_TRUE(queue.empty());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_capacity_is_one_less_than_size);
+    RUN_TEST(test_front_and_drop);
+    RUN_TEST(test_threads_keep_order_without_loss);
+    RUN_TEST(test_threads_front_drop);
+    return UNITY_END();
+}